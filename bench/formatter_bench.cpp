@@ -0,0 +1,435 @@
+#include "minispdlog/pattern_formatter.h"
+#include "minispdlog/details/log_msg.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(MINISPDLOG_LINUX) && defined(__has_include)
+#if __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define MINISPDLOG_BENCH_PERF 1
+#endif
+#endif
+
+// minispdlog_formatter_bench: pattern_formatter 微基准
+//
+// 分组:
+//   - pattern:   若干典型 pattern × 不同 payload 长度,整条 format() 的耗时
+//   - flag:      单个占位符的耗时;flag_formatter 是 pattern_formatter.cpp 的内部类型,
+//                这里用 "同一占位符重复 8 次" 与空 pattern 的差值除以 8 得到单个 kernel 的开销
+//   - time_cache: get_time 的命中(同一秒)与未命中(每条记录换一秒,走 localtime_r)路径
+//   - compile:   构造(compile_pattern)与 clone()
+//
+// 每个用例重复 --repeat 轮,取每轮 ns/record 的中位数;
+// instructions/record 来自 perf_event_open(用户态指令数),不可用时输出 n/a
+
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+// 用户态指令计数器(perf_event_open);打开失败时 available() 为 false
+class instruction_counter {
+public:
+    instruction_counter() {
+#ifdef MINISPDLOG_BENCH_PERF
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~instruction_counter() {
+#ifdef MINISPDLOG_BENCH_PERF
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    instruction_counter(const instruction_counter&) = delete;
+    instruction_counter& operator=(const instruction_counter&) = delete;
+
+    bool available() const {
+        return fd_ >= 0;
+    }
+
+    void start() {
+#ifdef MINISPDLOG_BENCH_PERF
+        if (fd_ >= 0) {
+            ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef MINISPDLOG_BENCH_PERF
+        if (fd_ >= 0) {
+            ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (::read(fd_, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int fd_{-1};
+};
+
+struct bench_options {
+    size_t iterations = 200000;     // 每轮的记录数(compile 组自动缩小)
+    size_t repeat = 5;              // 轮数,取中位数
+    std::string filter;             // 只运行名称包含该子串的用例
+    std::string format = "table";   // table | csv | json
+    std::string out;                // 输出文件(空 = 标准输出)
+};
+
+struct bench_result {
+    std::string group;
+    std::string name;
+    size_t iterations = 0;
+    double ns = 0;                  // ns/record(flag 组为单个 kernel 的 ns)
+    double instructions = -1;       // instructions/record,-1 = 不可用
+    double bytes = 0;               // 每条记录输出的字节数
+};
+
+// 防止编译器把结果优化掉
+volatile size_t g_sink = 0;
+
+class runner {
+public:
+    explicit runner(const bench_options& opts)
+        : opts_(opts)
+    {}
+
+    bool selected(const std::string& name) const {
+        return opts_.filter.empty() || name.find(opts_.filter) != std::string::npos;
+    }
+
+    // body(i) 执行一次被测操作并返回输出字节数
+    template<typename Body>
+    bench_result run(const std::string& group, const std::string& name, size_t iterations, Body body) {
+        // 预热:填充缓存、分配缓冲区、让时间缓存进入稳定状态
+        for (size_t i = 0; i < std::min<size_t>(iterations, 1000); ++i) {
+            g_sink = g_sink + body(i);
+        }
+
+        std::vector<double> ns;
+        std::vector<double> instr;
+        size_t bytes = 0;
+        for (size_t r = 0; r < opts_.repeat; ++r) {
+            size_t total = 0;
+            counter_.start();
+            auto start = clock_type::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                total += body(i);
+            }
+            auto elapsed = clock_type::now() - start;
+            uint64_t count = counter_.stop();
+            g_sink = g_sink + total;
+            bytes = total;
+            ns.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / iterations);
+            instr.push_back(static_cast<double>(count) / iterations);
+        }
+
+        bench_result res;
+        res.group = group;
+        res.name = name;
+        res.iterations = iterations;
+        res.ns = median_(ns);
+        res.instructions = counter_.available() ? median_(instr) : -1;
+        res.bytes = static_cast<double>(bytes) / iterations;
+        return res;
+    }
+
+    bool perf_available() const {
+        return counter_.available();
+    }
+
+private:
+    static double median_(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    const bench_options& opts_;
+    instruction_counter counter_;
+};
+
+void print_usage(std::ostream& out) {
+    out << "usage: minispdlog_formatter_bench [options]\n"
+        << "  --iterations N   records per round (default: 200000)\n"
+        << "  --repeat N       rounds per case, median is reported (default: 5)\n"
+        << "  --filter TEXT    only run cases whose name contains TEXT\n"
+        << "  --format F       table, json or csv (default: table)\n"
+        << "  --out FILE       write results to FILE instead of stdout\n";
+}
+
+bench_options parse_options(int argc, char** argv) {
+    bench_options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--iterations") {
+            opts.iterations = std::stoull(value());
+        } else if (arg == "--repeat") {
+            opts.repeat = std::stoull(value());
+        } else if (arg == "--filter") {
+            opts.filter = value();
+        } else if (arg == "--format") {
+            opts.format = value();
+        } else if (arg == "--out") {
+            opts.out = value();
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(std::cout);
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("unknown option: " + arg);
+        }
+    }
+    if (opts.iterations == 0 || opts.repeat == 0) {
+        throw std::invalid_argument("iterations and repeat must be positive");
+    }
+    if (opts.format != "table" && opts.format != "json" && opts.format != "csv") {
+        throw std::invalid_argument("unknown format: " + opts.format);
+    }
+    return opts;
+}
+
+// 格式化一条记录,返回输出字节数;缓冲区在调用之间复用,和 sink 的 thread_local 缓冲区一致
+size_t format_once(minispdlog::formatter& f, const minispdlog::details::log_msg& msg, fmt::memory_buffer& buf) {
+    buf.clear();
+    f.format(msg, buf);
+    return buf.size();
+}
+
+void run_patterns(runner& r, const bench_options& opts, std::vector<bench_result>& results) {
+    const std::vector<std::pair<std::string, std::string>> patterns = {
+        {"payload", "%v"},
+        {"time", "[%H:%M:%S] %v"},
+        {"default", "[%Y-%m-%d %H:%M:%S] [%^%l%$] %v"},
+        {"full", "[%Y-%m-%d %H:%M:%S] [%n] [%L] [thread %t] %v"},
+    };
+    const size_t payload_sizes[] = {16, 128, 1024};
+
+    fmt::memory_buffer buf;
+    for (auto& p : patterns) {
+        for (size_t size : payload_sizes) {
+            std::string name = p.first + "/" + std::to_string(size) + "B";
+            if (!r.selected(name)) {
+                continue;
+            }
+            std::string payload(size, 'x');
+            minispdlog::details::log_msg msg("bench", minispdlog::level::info, payload);
+            minispdlog::pattern_formatter f(p.second);
+            results.push_back(r.run("pattern", name, opts.iterations, [&](size_t) {
+                return format_once(f, msg, buf);
+            }));
+        }
+    }
+}
+
+void run_flags(runner& r, const bench_options& opts, std::vector<bench_result>& results) {
+    // 每个 kernel 重复 8 次,减去空 pattern(get_time + 换行)后除以 8
+    const size_t repeat_n = 8;
+    const std::vector<std::pair<std::string, std::string>> flags = {
+        {"%Y", "%Y"}, {"%m", "%m"}, {"%d", "%d"}, {"%H", "%H"}, {"%M", "%M"}, {"%S", "%S"},
+        {"%l", "%l"}, {"%L", "%L"}, {"%n", "%n"}, {"%v", "%v"}, {"%t", "%t"},
+        {"%^%$", "%^%$"}, {"text", "%%"},
+    };
+
+    std::string payload(32, 'x');
+    minispdlog::details::log_msg msg("bench", minispdlog::level::info, payload);
+    fmt::memory_buffer buf;
+
+    minispdlog::pattern_formatter empty("");
+    bench_result base = r.run("flag", "(empty)", opts.iterations, [&](size_t) {
+        return format_once(empty, msg, buf);
+    });
+    if (r.selected("(empty)")) {
+        results.push_back(base);
+    }
+
+    for (auto& f : flags) {
+        if (!r.selected(f.first)) {
+            continue;
+        }
+        std::string pattern;
+        for (size_t i = 0; i < repeat_n; ++i) {
+            pattern += f.second;
+        }
+        minispdlog::pattern_formatter pf(pattern);
+        bench_result res = r.run("flag", f.first, opts.iterations, [&](size_t) {
+            return format_once(pf, msg, buf);
+        });
+        res.ns = std::max(0.0, (res.ns - base.ns) / repeat_n);
+        if (res.instructions >= 0) {
+            res.instructions = std::max(0.0, (res.instructions - base.instructions) / repeat_n);
+        }
+        res.bytes = (res.bytes - base.bytes) / repeat_n;
+        results.push_back(res);
+    }
+}
+
+void run_time_cache(runner& r, const bench_options& opts, std::vector<bench_result>& results) {
+    std::string payload(32, 'x');
+    minispdlog::pattern_formatter f("[%Y-%m-%d %H:%M:%S] [%^%l%$] %v");
+    fmt::memory_buffer buf;
+
+    if (r.selected("hit")) {
+        minispdlog::details::log_msg msg("bench", minispdlog::level::info, payload);
+        results.push_back(r.run("time_cache", "hit", opts.iterations, [&](size_t) {
+            return format_once(f, msg, buf);
+        }));
+    }
+
+    if (r.selected("miss")) {
+        // 每条记录落在不同的一秒,每次都走 localtime_r
+        minispdlog::details::log_msg msg("bench", minispdlog::level::info, payload);
+        auto base = msg.time;
+        results.push_back(r.run("time_cache", "miss", opts.iterations, [&](size_t i) {
+            msg.time = base + std::chrono::seconds(static_cast<int64_t>(i) + 1);
+            return format_once(f, msg, buf);
+        }));
+    }
+}
+
+void run_compile(runner& r, const bench_options& opts, std::vector<bench_result>& results) {
+    const std::string pattern = "[%Y-%m-%d %H:%M:%S] [%n] [%L] [thread %t] %v";
+    size_t iterations = std::max<size_t>(opts.iterations / 10, 1);
+
+    if (r.selected("compile")) {
+        results.push_back(r.run("compile", "compile", iterations, [&](size_t) {
+            minispdlog::pattern_formatter f(pattern);
+            (void)f;
+            return size_t(0);
+        }));
+    }
+
+    if (r.selected("clone")) {
+        minispdlog::pattern_formatter f(pattern);
+        results.push_back(r.run("compile", "clone", iterations, [&](size_t) {
+            auto c = f.clone();
+            return c ? size_t(0) : size_t(1);
+        }));
+    }
+}
+
+void write_table(std::ostream& out, const std::vector<bench_result>& results) {
+    out << std::left << std::setw(12) << "group" << std::setw(18) << "case" << std::right
+        << std::setw(12) << "ns/record" << std::setw(14) << "instr/record" << std::setw(10) << "bytes" << "\n";
+    out << std::string(66, '-') << "\n";
+    for (const auto& r : results) {
+        out << std::left << std::setw(12) << r.group << std::setw(18) << r.name << std::right
+            << std::fixed << std::setprecision(1) << std::setw(12) << r.ns << std::setw(14);
+        if (r.instructions >= 0) {
+            out << r.instructions;
+        } else {
+            out << "n/a";
+        }
+        out << std::setw(10) << r.bytes << "\n";
+    }
+}
+
+void write_csv(std::ostream& out, const std::vector<bench_result>& results) {
+    out << "group,case,iterations,ns_per_record,instructions_per_record,bytes_per_record\n";
+    for (const auto& r : results) {
+        out << r.group << ',' << r.name << ',' << r.iterations << ','
+            << std::fixed << std::setprecision(2) << r.ns << ',';
+        if (r.instructions >= 0) {
+            out << r.instructions;
+        }
+        out << ',' << r.bytes << '\n';
+    }
+}
+
+void write_json(std::ostream& out, bool perf, const std::vector<bench_result>& results) {
+    out << "{\n"
+        << "  \"perf_counters\": " << (perf ? "true" : "false") << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const bench_result& r = results[i];
+        out << "    {\"group\": \"" << r.group << "\", \"case\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << ", \"ns_per_record\": " << std::fixed << std::setprecision(2) << r.ns
+            << ", \"instructions_per_record\": ";
+        if (r.instructions >= 0) {
+            out << r.instructions;
+        } else {
+            out << "null";
+        }
+        out << ", \"bytes_per_record\": " << r.bytes << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench_options opts;
+    try {
+        opts = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "minispdlog_formatter_bench: " << e.what() << "\n";
+        print_usage(std::cerr);
+        return 2;
+    }
+
+    try {
+        runner r(opts);
+        if (!r.perf_available()) {
+            std::cerr << "perf_event_open unavailable, instructions/record not reported\n";
+        }
+
+        std::vector<bench_result> results;
+        run_patterns(r, opts, results);
+        run_flags(r, opts, results);
+        run_time_cache(r, opts, results);
+        run_compile(r, opts, results);
+
+        std::ofstream file;
+        if (!opts.out.empty()) {
+            file.open(opts.out, std::ios::out | std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error("Failed to open file: " + opts.out);
+            }
+        }
+        std::ostream& out = opts.out.empty() ? std::cout : file;
+        if (opts.format == "json") {
+            write_json(out, r.perf_available(), results);
+        } else if (opts.format == "csv") {
+            write_csv(out, results);
+        } else {
+            write_table(out, results);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "minispdlog_formatter_bench: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,500 @@
+#include "minispdlog/minispdlog.h"
+#include "minispdlog/async.h"
+#include "minispdlog/sinks/null_sink.h"
+#include "minispdlog/details/histogram.h"
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef MINISPDLOG_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifndef MINISPDLOG_BENCH_VERSION
+#define MINISPDLOG_BENCH_VERSION "unknown"
+#endif
+
+// minispdlog_bench: 吞吐与单次调用延迟基准
+//
+// 每个场景(模式 × sink × 生产者线程数)分两个阶段,各自使用新建的 logger:
+//   1. 吞吐:各线程尽快写入,计时到最后一条落到 sink 为止
+//      (同步模式 flush 之后;异步模式线程池析构、队列排空之后)
+//   2. 延迟:各线程按固定速率写入,第 k 次调用的计划时刻为 start + k * interval,
+//      latency = 调用返回时刻 - 计划时刻
+//      某次调用卡住时,其后被推迟的调用也会计入等待时间,不会因为"停顿期间没有发出请求"
+//      而低估尾延迟(coordinated omission);service = 调用返回 - 实际开始,作对照
+//
+// 输出:默认打印表格;--format json|csv 输出机器可读结果,便于跨版本比较
+
+using clock_type = std::chrono::steady_clock;
+using minispdlog::details::histogram_snapshot;
+using minispdlog::details::log_histogram;
+
+namespace {
+
+struct bench_options {
+    std::vector<std::string> modes{"sync_st", "sync_mt", "async"};
+    std::vector<std::string> sinks{"null", "file", "rotating"};
+    std::vector<size_t> threads{1, 2, 4};
+    size_t messages = 200000;           // 吞吐阶段每个场景的消息总数
+    size_t latency_messages = 20000;    // 延迟阶段每个场景的消息总数
+    double rate = 100000;               // 延迟阶段所有线程合计的速率(条/秒),0 = 跳过
+    size_t queue_size = 8192;           // 异步模式的队列容量
+    bool pin = false;                   // 第 i 个生产者线程绑定到 CPU (i % 核数)
+    std::string format = "table";       // table | json | csv
+    std::string out;                    // 输出文件(空 = 标准输出)
+    std::string dir = "logs/bench";     // 文件 sink 的目录
+};
+
+struct bench_result {
+    std::string mode;
+    std::string sink;
+    size_t threads = 0;
+    size_t messages = 0;
+    double elapsed_ms = 0;
+    double throughput = 0;              // 条/秒
+    histogram_snapshot latency;         // 相对计划时刻(纳秒)
+    histogram_snapshot service;         // 相对实际开始(纳秒)
+};
+
+void print_usage(std::ostream& out) {
+    out << "usage: minispdlog_bench [options]\n"
+        << "  --modes LIST        sync_st,sync_mt,async (default: all)\n"
+        << "  --sinks LIST        null,file,rotating (default: all)\n"
+        << "  --threads LIST      producer thread counts (default: 1,2,4)\n"
+        << "  --messages N        messages per throughput run (default: 200000)\n"
+        << "  --latency-messages N  messages per latency run (default: 20000)\n"
+        << "  --rate R            total calls/s in the latency run, 0 = skip (default: 100000)\n"
+        << "  --queue-size N      async queue capacity (default: 8192)\n"
+        << "  --pin               pin producer i to CPU i % ncpu\n"
+        << "  --format F          table, json or csv (default: table)\n"
+        << "  --out FILE          write results to FILE instead of stdout\n"
+        << "  --dir DIR           directory for file sinks (default: logs/bench)\n";
+}
+
+std::vector<std::string> split_list(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    if (items.empty()) {
+        throw std::invalid_argument("empty list: " + value);
+    }
+    return items;
+}
+
+size_t parse_size(const std::string& value) {
+    size_t pos = 0;
+    unsigned long long n = std::stoull(value, &pos);
+    if (pos != value.size()) {
+        throw std::invalid_argument("not a number: " + value);
+    }
+    return static_cast<size_t>(n);
+}
+
+bool contains(const std::vector<std::string>& allowed, const std::string& value) {
+    for (auto& a : allowed) {
+        if (a == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bench_options parse_options(int argc, char** argv) {
+    bench_options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--modes") {
+            opts.modes = split_list(value());
+        } else if (arg == "--sinks") {
+            opts.sinks = split_list(value());
+        } else if (arg == "--threads") {
+            opts.threads.clear();
+            for (auto& t : split_list(value())) {
+                opts.threads.push_back(parse_size(t));
+            }
+        } else if (arg == "--messages") {
+            opts.messages = parse_size(value());
+        } else if (arg == "--latency-messages") {
+            opts.latency_messages = parse_size(value());
+        } else if (arg == "--rate") {
+            opts.rate = std::stod(value());
+        } else if (arg == "--queue-size") {
+            opts.queue_size = parse_size(value());
+        } else if (arg == "--pin") {
+            opts.pin = true;
+        } else if (arg == "--format") {
+            opts.format = value();
+        } else if (arg == "--out") {
+            opts.out = value();
+        } else if (arg == "--dir") {
+            opts.dir = value();
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(std::cout);
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("unknown option: " + arg);
+        }
+    }
+
+    for (auto& m : opts.modes) {
+        if (!contains({"sync_st", "sync_mt", "async"}, m)) {
+            throw std::invalid_argument("unknown mode: " + m);
+        }
+    }
+    for (auto& s : opts.sinks) {
+        if (!contains({"null", "file", "rotating"}, s)) {
+            throw std::invalid_argument("unknown sink: " + s);
+        }
+    }
+    for (size_t t : opts.threads) {
+        if (t == 0) {
+            throw std::invalid_argument("thread count must be positive");
+        }
+    }
+    if (!contains({"table", "json", "csv"}, opts.format)) {
+        throw std::invalid_argument("unknown format: " + opts.format);
+    }
+    if (opts.rate < 0) {
+        throw std::invalid_argument("rate must not be negative");
+    }
+    return opts;
+}
+
+void pin_to_cpu(size_t index) {
+#ifdef MINISPDLOG_LINUX
+    unsigned ncpu = std::thread::hardware_concurrency();
+    if (ncpu == 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<int>(index % ncpu), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)index;
+#endif
+}
+
+// 一个场景的被测对象;finish() 等所有消息落到 sink
+struct bench_target {
+    std::shared_ptr<minispdlog::logger> logger;
+    std::shared_ptr<minispdlog::details::thread_pool> pool;     // 仅异步模式
+
+    void finish() {
+        if (pool) {
+            // 先释放 logger,线程池析构时处理完积压消息再退出
+            logger.reset();
+            pool.reset();
+        } else {
+            logger->flush();
+        }
+    }
+};
+
+minispdlog::sinks::sink_ptr make_sink(const bench_options& opts, const std::string& mode,
+                                      const std::string& sink, size_t threads) {
+    namespace sinks = minispdlog::sinks;
+    bool st = mode == "sync_st";
+    std::string path = opts.dir + "/" + mode + "_" + sink + "_" + std::to_string(threads) + ".log";
+
+    if (sink == "null") {
+        if (st) {
+            return std::make_shared<sinks::null_sink_st>();
+        }
+        return std::make_shared<sinks::null_sink_mt>();
+    }
+    if (sink == "file") {
+        if (st) {
+            return std::make_shared<sinks::file_sink_st>(path, true);
+        }
+        return std::make_shared<sinks::file_sink_mt>(path, true);
+    }
+    const size_t max_size = 16 * 1024 * 1024;
+    if (st) {
+        return std::make_shared<sinks::rotating_file_sink_st>(path, max_size, 3);
+    }
+    return std::make_shared<sinks::rotating_file_sink_mt>(path, max_size, 3);
+}
+
+bench_target make_target(const bench_options& opts, const std::string& mode,
+                         const std::string& sink, size_t threads) {
+    bench_target target;
+    auto s = make_sink(opts, mode, sink, threads);
+    std::string name = "bench_" + mode + "_" + sink;
+    if (mode == "async") {
+        target.pool = std::make_shared<minispdlog::details::thread_pool>(opts.queue_size, 1);
+        target.logger = std::make_shared<minispdlog::async_logger>(
+            name, s, target.pool, minispdlog::async_overflow_policy::block);
+    } else {
+        target.logger = std::make_shared<minispdlog::logger>(name, s);
+    }
+    return target;
+}
+
+// 启动 n 个生产者线程,全部就绪后同时开始;返回开始时刻
+template<typename Body>
+clock_type::time_point run_producers(const bench_options& opts, size_t n, Body body) {
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < n; ++t) {
+        producers.emplace_back([&, t] {
+            if (opts.pin) {
+                pin_to_cpu(t);
+            }
+            ready.fetch_add(1, std::memory_order_relaxed);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            body(t);
+        });
+    }
+    while (ready.load(std::memory_order_relaxed) != n) {
+        std::this_thread::yield();
+    }
+    auto start = clock_type::now();
+    go.store(true, std::memory_order_release);
+    for (auto& p : producers) {
+        p.join();
+    }
+    return start;
+}
+
+void run_throughput(const bench_options& opts, bench_result& r) {
+    auto target = make_target(opts, r.mode, r.sink, r.threads);
+    auto* logger = target.logger.get();
+    size_t per_thread = opts.messages / r.threads;
+
+    auto start = run_producers(opts, r.threads, [&](size_t t) {
+        for (size_t i = 0; i < per_thread; ++i) {
+            logger->info("bench message {} from thread {}: the quick brown fox jumps over the lazy dog", i, t);
+        }
+    });
+    target.finish();
+    auto elapsed = clock_type::now() - start;
+
+    r.messages = per_thread * r.threads;
+    r.elapsed_ms = std::chrono::duration<double, std::milli>(elapsed).count();
+    r.throughput = r.elapsed_ms > 0 ? r.messages / (r.elapsed_ms / 1000.0) : 0;
+}
+
+// 等到计划时刻:较远时睡眠,接近时让出 CPU
+clock_type::time_point wait_until(clock_type::time_point when) {
+    for (;;) {
+        auto now = clock_type::now();
+        if (now >= when) {
+            return now;
+        }
+        auto left = when - now;
+        if (left > std::chrono::microseconds(200)) {
+            std::this_thread::sleep_for(left - std::chrono::microseconds(100));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void run_latency(const bench_options& opts, bench_result& r) {
+    if (opts.rate <= 0) {
+        return;
+    }
+    auto target = make_target(opts, r.mode, r.sink, r.threads);
+    auto* logger = target.logger.get();
+    size_t per_thread = opts.latency_messages / r.threads;
+
+    // 每个线程的间隔为 threads / rate 秒,各线程的起点错开 interval / threads
+    auto interval = std::chrono::nanoseconds(static_cast<int64_t>(r.threads * 1e9 / opts.rate));
+    std::vector<std::unique_ptr<log_histogram>> latency(r.threads);
+    std::vector<std::unique_ptr<log_histogram>> service(r.threads);
+    for (size_t t = 0; t < r.threads; ++t) {
+        latency[t] = std::make_unique<log_histogram>();
+        service[t] = std::make_unique<log_histogram>();
+    }
+    auto begin = clock_type::now() + std::chrono::milliseconds(1);
+
+    run_producers(opts, r.threads, [&](size_t t) {
+        auto first = begin + interval * static_cast<int64_t>(t) / static_cast<int64_t>(r.threads);
+        for (size_t i = 0; i < per_thread; ++i) {
+            auto intended = first + interval * static_cast<int64_t>(i);
+            auto actual = wait_until(intended);
+            logger->info("bench message {} from thread {}: the quick brown fox jumps over the lazy dog", i, t);
+            auto done = clock_type::now();
+            latency[t]->record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(done - intended).count()));
+            service[t]->record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(done - actual).count()));
+        }
+    });
+    target.finish();
+
+    for (size_t t = 0; t < r.threads; ++t) {
+        r.latency.merge(latency[t]->snapshot());
+        r.service.merge(service[t]->snapshot());
+    }
+}
+
+std::string iso_time() {
+    std::time_t now = std::time(nullptr);
+    std::tm tm_val;
+#ifdef MINISPDLOG_WINDOWS
+    gmtime_s(&tm_val, &now);
+#else
+    gmtime_r(&now, &tm_val);
+#endif
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm_val);
+    return buf;
+}
+
+void write_histogram_json(std::ostream& out, const histogram_snapshot& h) {
+    out << "{\"count\": " << h.count << ", \"mean\": " << static_cast<uint64_t>(h.mean())
+        << ", \"p50\": " << h.percentile(0.50) << ", \"p90\": " << h.percentile(0.90)
+        << ", \"p99\": " << h.percentile(0.99) << ", \"p999\": " << h.percentile(0.999)
+        << ", \"max\": " << h.max << "}";
+}
+
+void write_json(std::ostream& out, const bench_options& opts, const std::vector<bench_result>& results) {
+    out << "{\n"
+        << "  \"library\": \"minispdlog\",\n"
+        << "  \"version\": \"" << MINISPDLOG_BENCH_VERSION << "\",\n"
+        << "  \"timestamp\": \"" << iso_time() << "\",\n"
+        << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+        << "  \"pinned\": " << (opts.pin ? "true" : "false") << ",\n"
+        << "  \"latency_rate\": " << std::fixed << std::setprecision(0) << opts.rate << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const bench_result& r = results[i];
+        out << "    {\"mode\": \"" << r.mode << "\", \"sink\": \"" << r.sink << "\", \"threads\": " << r.threads
+            << ", \"messages\": " << r.messages
+            << ", \"elapsed_ms\": " << std::setprecision(3) << r.elapsed_ms
+            << ", \"throughput\": " << std::setprecision(0) << r.throughput
+            << ", \"latency_ns\": ";
+        write_histogram_json(out, r.latency);
+        out << ", \"service_ns\": ";
+        write_histogram_json(out, r.service);
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void write_csv(std::ostream& out, const std::vector<bench_result>& results) {
+    out << "mode,sink,threads,messages,elapsed_ms,throughput,"
+        << "latency_count,latency_mean_ns,latency_p50_ns,latency_p90_ns,latency_p99_ns,latency_p999_ns,latency_max_ns,"
+        << "service_p50_ns,service_p99_ns,service_p999_ns,service_max_ns\n";
+    for (const auto& r : results) {
+        out << r.mode << ',' << r.sink << ',' << r.threads << ',' << r.messages << ','
+            << std::fixed << std::setprecision(3) << r.elapsed_ms << ','
+            << std::setprecision(0) << r.throughput << ','
+            << r.latency.count << ',' << static_cast<uint64_t>(r.latency.mean()) << ','
+            << r.latency.percentile(0.50) << ',' << r.latency.percentile(0.90) << ','
+            << r.latency.percentile(0.99) << ',' << r.latency.percentile(0.999) << ','
+            << r.latency.max << ','
+            << r.service.percentile(0.50) << ',' << r.service.percentile(0.99) << ','
+            << r.service.percentile(0.999) << ',' << r.service.max << '\n';
+    }
+}
+
+void write_table(std::ostream& out, const std::vector<bench_result>& results) {
+    auto us = [](uint64_t ns) {
+        return ns / 1000.0;
+    };
+    out << std::left << std::setw(8) << "mode" << std::setw(10) << "sink" << std::right
+        << std::setw(4) << "thr" << std::setw(12) << "msgs/s"
+        << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us"
+        << std::setw(10) << "max us" << std::setw(12) << "svc p99 us" << "\n";
+    out << std::string(86, '-') << "\n";
+    for (const auto& r : results) {
+        out << std::left << std::setw(8) << r.mode << std::setw(10) << r.sink << std::right
+            << std::setw(4) << r.threads
+            << std::setw(12) << std::fixed << std::setprecision(0) << r.throughput
+            << std::setprecision(1)
+            << std::setw(10) << us(r.latency.percentile(0.50))
+            << std::setw(10) << us(r.latency.percentile(0.99))
+            << std::setw(10) << us(r.latency.percentile(0.999))
+            << std::setw(10) << us(r.latency.max)
+            << std::setw(12) << us(r.service.percentile(0.99)) << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench_options opts;
+    try {
+        opts = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "minispdlog_bench: " << e.what() << "\n";
+        print_usage(std::cerr);
+        return 2;
+    }
+
+    try {
+        if (contains(opts.sinks, "file") || contains(opts.sinks, "rotating")) {
+            std::filesystem::create_directories(opts.dir);
+        }
+
+        std::vector<bench_result> results;
+        for (auto& mode : opts.modes) {
+            for (auto& sink : opts.sinks) {
+                for (size_t threads : opts.threads) {
+                    // 单线程版本的 sink 不能被多个线程同时使用
+                    if (mode == "sync_st" && threads != 1) {
+                        continue;
+                    }
+                    bench_result r;
+                    r.mode = mode;
+                    r.sink = sink;
+                    r.threads = threads;
+                    run_throughput(opts, r);
+                    run_latency(opts, r);
+                    results.push_back(std::move(r));
+                    std::cerr << "done: " << mode << " " << sink << " x" << threads << "\n";
+                }
+            }
+        }
+
+        std::ofstream file;
+        if (!opts.out.empty()) {
+            file.open(opts.out, std::ios::out | std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error("Failed to open file: " + opts.out);
+            }
+        }
+        std::ostream& out = opts.out.empty() ? std::cout : file;
+        if (opts.format == "json") {
+            write_json(out, opts, results);
+        } else if (opts.format == "csv") {
+            write_csv(out, results);
+        } else {
+            write_table(out, results);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "minispdlog_bench: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -35,6 +35,13 @@ inline void init_thread_pool(size_t queue_size, size_t threads_n = 1) {
     registry::instance().init_thread_pool(queue_size, threads_n);
 }
 
+// 按配置初始化全局线程池
+// 例:init_thread_pool({8192, 4, true}) 创建 4 个工作线程的分片线程池,
+//     每个异步 logger 固定由其中一个线程处理
+inline void init_thread_pool(const details::thread_pool_options& options) {
+    registry::instance().init_thread_pool(options);
+}
+
 // 获取全局线程池
 inline std::shared_ptr<details::thread_pool> thread_pool() {
     return registry::instance().thread_pool();
@@ -121,12 +128,14 @@ inline std::shared_ptr<async_logger> async_rotating_logger_mt(
     const std::string& filename,
     size_t max_size,
     size_t max_files,
-    async_overflow_policy overflow_policy = async_overflow_policy::block
+    async_overflow_policy overflow_policy = async_overflow_policy::block,
+    sinks::rotation_scheme scheme = sinks::rotation_scheme::rename_cascade
 ) {
     auto sink = std::make_shared<sinks::rotating_file_sink_mt>(
         filename, 
         max_size, 
-        max_files
+        max_files,
+        scheme
     );
     auto tp = registry::instance().thread_pool();
     auto new_logger = std::make_shared<async_logger>(
@@ -2,6 +2,8 @@
 
 #include "logger.h"
 #include "details/thread_pool.h"
+#include <atomic>
+#include <chrono>
 #include <memory>
 
 namespace minispdlog {
@@ -12,10 +14,18 @@ class thread_pool;
 }
 
 // 溢出策略枚举
-// 参考 spdlog 设计:队列满时的两种处理方式
+// 参考 spdlog 设计:队列满时的处理方式
+// discard_new / block_with_timeout 丢弃的消息会被计数,计数随该 logger 下一条成功入队的
+// 消息(或 flush 请求)进入队列,后台线程在它之前输出一条合成的 "N messages dropped" 警告
 enum class async_overflow_policy {
-    block,          // 阻塞调用者,等待队列有空闲槽位(默认,保证不丢消息)
-    overrun_oldest  // 立即覆盖最旧消息(非阻塞,但可能丢消息)
+    block,              // 阻塞调用者,等待队列有空闲槽位(默认,保证不丢消息)
+    overrun_oldest,     // 立即覆盖最旧消息(非阻塞,但可能丢消息)
+    discard_new,        // 丢弃新消息并计数(非阻塞,保留已排队的历史)
+    block_with_timeout, // 最多阻塞 overflow_timeout(),仍然满则丢弃新消息并计数
+    caller_runs         // 调用线程直接把这条记录写入本 logger 的 sink(不休眠、不丢消息)
+                        // 调用线程与工作线程会同时访问这些 sink,因此要求所有 sink 都是线程安全的
+                        // (_mt 版本,sink::thread_safe());含 _st sink 或线程池为分片模式时,
+                        // 构造时抛出 std::invalid_argument
 };
 
 // async_logger:异步日志记录器
@@ -35,6 +45,8 @@ class MINISPDLOG_API async_logger final
 {
     // thread_pool 需要访问 backend_sink_it_()
     friend class details::thread_pool;
+    // registry 的周期刷新需要按线程池合并刷新请求
+    friend class registry;
 
 public:
     // 构造函数:迭代器版本
@@ -49,7 +61,10 @@ public:
         : logger(std::move(name), begin, end)
         , thread_pool_(std::move(tp))
         , overflow_policy_(policy)
-    {}
+        , shard_key_(std::hash<std::string>()(name_))
+    {
+        check_overflow_policy_();
+    }
 
     // 构造函数:单个 Sink
     async_logger(
@@ -72,6 +87,31 @@ public:
     // 禁止拷贝
     async_logger(const async_logger&) = delete;
     async_logger& operator=(const async_logger&) = delete;
+    
+    // 分片线程池中固定由第 index 个工作线程处理(对工作线程数取模)
+    // 默认按名称哈希分配;应在开始记录日志之前调用,否则切换前后的消息可能乱序
+    void pin_to_worker(size_t index);
+    
+    // block_with_timeout 策略下的最长阻塞时间(默认 100ms)
+    void set_overflow_timeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds overflow_timeout() const;
+    
+    // discard_new / block_with_timeout 策略下累计丢弃的消息数
+    size_t dropped_count() const;
+    
+    // 端到端延迟采样:每个用户线程在本 logger 上每 every_n 条记录采样一条(0 = 关闭,默认)
+    // 计数按 logger 分开、按线程分片(details::striped_counters),线程数超过分片数时
+    // 共用分片的线程合起来每 every_n 条采样一条
+    // 被采样的记录在投递、工作线程取出、sink 开始写入、写入完成时各打一个时间戳,
+    // 各阶段耗时记入本 logger 和所在线程池的直方图;未被采样的记录没有额外开销
+    void set_latency_sampling(size_t every_n);
+    size_t latency_sampling() const;
+    
+    // 本 logger 采样到的各阶段延迟(纳秒)
+    details::latency_snapshot latency() const;
+    
+    // 把 latency() 写成文本报告(格式见 details::write_latency_report),失败时抛出异常
+    void dump_latency(const std::string& filename) const;
 
 protected:
     // 重写 logger 的虚函数:将消息 post 到队列(非阻塞返回)
@@ -80,16 +120,41 @@ protected:
     // 重写 flush:向队列 post 刷新请求
     void flush_() override;
 
+    // 重写持久化刷新:向队列 post sync 请求,返回凭据
+    // 注意:overrun_oldest 策略下 sync 请求本身也可能被覆盖,此时凭据的 wait() 抛出
+    // std::future_error(broken_promise),不会永远等待
+    flush_ticket flush_durable_() override;
+
     // 后台线程调用:真正执行日志输出
     // 注意:这个方法在工作线程中执行,不是用户线程
     void backend_sink_it_(const details::log_msg& msg);
 
     // 后台线程调用:真正执行刷新
     void backend_flush_();
+    
+    // 后台线程调用:输出一条 "N messages dropped" 警告记录
+    void backend_report_dropped_(size_t dropped);
+    
+    // 用户线程调用:取走尚未随消息入队的丢弃数
+    size_t take_dropped_();
+    
+    // 所有 sink 是否都允许多个线程同时写入(caller_runs 使用)
+    bool sinks_thread_safe_() const;
 
 private:
+    // 构造时检查 caller_runs:生产者会与工作线程同时写本 logger 的 sink,
+    // 要求 sink 线程安全,且不能破坏分片模式"每个 sink 只被一个线程访问"的保证
+    void check_overflow_policy_() const;
+
     std::weak_ptr<details::thread_pool> thread_pool_;  // 线程池(弱引用)
     async_overflow_policy overflow_policy_;             // 溢出策略
+    std::atomic<size_t> shard_key_;                     // 分片线程池中选择工作线程的键
+    std::atomic<int64_t> overflow_timeout_ms_{100};     // block_with_timeout 的最长阻塞时间
+    std::atomic<size_t> dropped_total_{0};              // 累计丢弃数
+    std::atomic<size_t> dropped_pending_{0};            // 尚未随消息入队的丢弃数
+    std::atomic<size_t> latency_sampling_{0};           // 延迟采样间隔(0 = 关闭)
+    details::striped_counters<1> sample_ticks_;         // 本 logger 的采样计数(按线程分片)
+    details::latency_histograms latency_;               // 采样到的各阶段延迟(后台线程写)
 };
 
 } // namespace minispdlog
\ No newline at end of file
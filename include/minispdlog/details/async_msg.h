@@ -3,6 +3,8 @@
 #include "log_msg.h"
 #include <memory>
 #include <string>
+#include <cstdint>
+#include <future>
 #include <iostream>
 namespace minispdlog {
 
@@ -15,6 +17,8 @@ namespace details {
 enum class async_msg_type {
     log,        // 普通日志消息
     flush,      // 刷新请求
+    flush_all,  // 合并的批量刷新请求(见 thread_pool::post_flush_all)
+    sync,       // 持久化刷新请求(见 thread_pool::post_sync)
     terminate   // 终止线程池
 };
 
@@ -73,6 +77,16 @@ struct async_msg : log_msg_buffer {
     // 原因:thread_pool 需要调用 async_logger::backend_sink_it_()
     async_logger_ptr worker_ptr;
     
+    // sync 请求的序号(其他类型为 0)
+    uint64_t seq{0};
+    
+    // sync 请求的完成通知(随消息一起入队)
+    // overrun_oldest 覆盖这条消息时 promise 随之析构,等待者收到 broken_promise,不会永远挂起
+    std::promise<void> done;
+    
+    // 在这条消息之前因溢出策略被丢弃的本 logger 消息数(后台线程据此合成报告)
+    size_t dropped{0};
+    
     // 默认构造
     async_msg() = default;
     ~async_msg() = default;
@@ -82,6 +96,9 @@ struct async_msg : log_msg_buffer {
         : log_msg_buffer(std::move(other))  // 调用父类移动构造
         , msg_type(other.msg_type)
         , worker_ptr(std::move(other.worker_ptr))
+        , seq(other.seq)
+        , done(std::move(other.done))
+        , dropped(other.dropped)
     {}
     
     // ✅ 添加移动赋值函数
@@ -90,6 +107,9 @@ struct async_msg : log_msg_buffer {
             log_msg_buffer::operator=(std::move(other));  // 调用父类移动赋值
             msg_type = other.msg_type;
             worker_ptr = std::move(other.worker_ptr);
+            seq = other.seq;
+            done = std::move(other.done);
+            dropped = other.dropped;
         }
         return *this;
     }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../common.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+
+namespace minispdlog {
+namespace details {
+
+// background_worker: 单个后台线程,按投递顺序执行任务
+// 用于把可能阻塞的文件操作(fclose/fsync/unlink/预创建文件)移出 sink 的临界区
+//
+// 特性:
+//   - post() 只在队列上加一次锁,不等待任务执行
+//   - 析构时先执行完所有已投递的任务,再退出线程
+//   - 任务抛出的异常被吞掉(后台线程无处上报)
+class MINISPDLOG_API background_worker {
+public:
+    background_worker();
+    ~background_worker();
+    
+    background_worker(const background_worker&) = delete;
+    background_worker& operator=(const background_worker&) = delete;
+    
+    // 投递任务
+    void post(std::function<void()> task);
+    
+private:
+    void worker_loop_();
+    
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_{false};
+    std::thread thread_;        // 最后初始化,保证线程启动时其他成员已就绪
+};
+
+} // namespace details
+} // namespace minispdlog
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "../common.h"
+#include "log_msg.h"
+#include <array>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace minispdlog {
+namespace details {
+
+// combining_mutex: base_sink 的 flat-combining 锁策略
+//
+// 用法: file_sink<details::combining_mutex>(见各 sink 的 _fc 别名)
+//
+// 工作方式:
+//   - 没有竞争时和普通 mutex 一样:拿到锁直接写
+//   - 拿不到锁的线程把自己的 log_msg 地址(以及锁外格式化好的文本)发布到一个槽位里,然后等待
+//   - 持有锁的线程(combiner)在释放前扫描所有槽位,把已发布的记录一并写完
+//   - 等待者发现自己的槽位被标记为完成后直接返回,整个过程不必再抢锁
+//   - 高并发下一次加锁处理一批记录,避免每条记录都产生一次锁交接(lock convoy)
+//
+// 槽位:
+//   - 固定 max_slots 个,每次调用用 CAS 抢占一个空闲槽位(从线程哈希位置开始找)
+//   - 全部被占用时退化为普通加锁
+//   - sink_it_ 抛出的异常会被带回到发布该记录的线程
+//
+// lock()/unlock() 保留普通 mutex 语义,供 flush()/set_level() 等非热路径使用
+class combining_mutex {
+public:
+    static constexpr size_t max_slots = 64;
+
+    void lock() {
+        mutex_.lock();
+    }
+
+    void unlock() {
+        mutex_.unlock();
+    }
+
+    bool try_lock() {
+        return mutex_.try_lock();
+    }
+
+    // 写入一条记录:sink_fn(msg, formatted) 只会在持有内部锁时被调用(可能由其他线程代为调用)
+    // formatted 原样传回 sink_fn,其指向的数据在本调用返回前保持有效
+    template<typename SinkFn>
+    void combine(const log_msg& msg, std::string_view formatted, SinkFn&& sink_fn) {
+        // 快速路径:无竞争
+        if (mutex_.try_lock()) {
+            std::lock_guard<std::mutex> lock(mutex_, std::adopt_lock);
+            sink_fn(msg, formatted);
+            drain_(sink_fn);
+            return;
+        }
+
+        slot* s = claim_slot_();
+        if (!s) {
+            // 槽位耗尽:退化为普通加锁
+            std::lock_guard<std::mutex> lock(mutex_);
+            sink_fn(msg, formatted);
+            drain_(sink_fn);
+            return;
+        }
+
+        s->msg = &msg;
+        s->formatted = formatted;
+        s->state.store(slot_published, std::memory_order_release);
+        pending_.fetch_add(1, std::memory_order_release);
+
+        for (unsigned spins = 0;; ++spins) {
+            if (s->state.load(std::memory_order_acquire) == slot_done) {
+                break;
+            }
+
+            // 自己成为 combiner:连同自己的槽位一起处理
+            if (mutex_.try_lock()) {
+                std::lock_guard<std::mutex> lock(mutex_, std::adopt_lock);
+                drain_(sink_fn);
+                break;
+            }
+
+            if (spins > 64) {
+                std::this_thread::yield();
+            }
+        }
+
+        std::exception_ptr error = std::move(s->error);
+        s->error = nullptr;
+        s->state.store(slot_free, std::memory_order_release);
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    enum : int {
+        slot_free = 0,       // 空闲
+        slot_claimed = 1,    // 已被某线程占用,尚未发布
+        slot_published = 2,  // 记录已发布,等待 combiner 处理
+        slot_done = 3        // 已处理,等待发布者取回结果
+    };
+
+    // 每个槽位独占一个缓存行,避免伪共享
+    struct alignas(64) slot {
+        std::atomic<int> state{slot_free};
+        const log_msg* msg{nullptr};
+        std::string_view formatted;
+        std::exception_ptr error;
+    };
+
+    slot* claim_slot_() {
+        // 每个线程从固定的起点开始找,通常第一次 CAS 就能成功
+        static thread_local size_t start =
+            std::hash<std::thread::id>()(std::this_thread::get_id()) % max_slots;
+
+        for (size_t i = 0; i < max_slots; ++i) {
+            slot& s = slots_[(start + i) % max_slots];
+            int expected = slot_free;
+            if (s.state.load(std::memory_order_relaxed) == slot_free &&
+                s.state.compare_exchange_strong(expected, slot_claimed, std::memory_order_acquire)) {
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+    // 在持有锁时处理所有已发布的记录
+    template<typename SinkFn>
+    void drain_(SinkFn& sink_fn) {
+        // 没有等待者时不扫描槽位,无竞争路径只多一次原子读
+        if (pending_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+        for (auto& s : slots_) {
+            if (s.state.load(std::memory_order_acquire) != slot_published) {
+                continue;
+            }
+            try {
+                sink_fn(*s.msg, s.formatted);
+            } catch (...) {
+                s.error = std::current_exception();
+            }
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            s.state.store(slot_done, std::memory_order_release);
+        }
+    }
+
+    std::mutex mutex_;
+    alignas(64) std::atomic<size_t> pending_{0};   // 已发布但尚未处理的槽位数
+    std::array<slot, max_slots> slots_;
+};
+
+} // namespace details
+} // namespace minispdlog
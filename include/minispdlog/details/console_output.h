@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../common.h"
+#include <cstddef>
+#include <cstdio>
+
+#ifdef MINISPDLOG_WINDOWS
+    #include <io.h>
+#else
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+namespace minispdlog {
+namespace details {
+
+// 控制台输出辅助函数:直接写文件描述符 1/2,绕过 iostream/stdio 缓冲
+// 注意:与 std::cout/printf 混用时,两者之间的先后顺序不保证
+
+constexpr int stdout_fd = 1;
+constexpr int stderr_fd = 2;
+
+// 把 [data, data+len) 全部写到 fd(处理短写和 EINTR,失败时放弃)
+inline void console_write(int fd, const char* data, size_t len) {
+#ifdef MINISPDLOG_WINDOWS
+    ::_write(fd, data, static_cast<unsigned int>(len));
+#else
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // 控制台写失败(如管道关闭)不应影响业务
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+#endif
+}
+
+// fd 是否连接到终端
+inline bool console_is_tty(int fd) {
+#ifdef MINISPDLOG_WINDOWS
+    return ::_isatty(fd) != 0;
+#else
+    return ::isatty(fd) != 0;
+#endif
+}
+
+} // namespace details
+} // namespace minispdlog
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../common.h"
+#include <string>
+#include <cstddef>
+
+#ifndef MINISPDLOG_WINDOWS
+
+#include <sys/types.h>
+
+namespace minispdlog {
+namespace details {
+
+// direct_file_writer: 绕过页缓存的对齐块写入器(仅 POSIX)
+//
+// 工作方式:
+//   - 以 O_DIRECT 打开文件(macOS 上用 F_NOCACHE),日志写入不再挤占页缓存
+//   - 记录先拷贝进 4KB 对齐的缓冲区,缓冲区写满后整块 pwrite 到对齐偏移
+//   - flush() 把不足一块的尾部补 0 到整块写出,再 ftruncate 回逻辑长度;
+//     尾部留在缓冲区中,后续记录接着写,下次写出时覆盖同一块
+//   - 追加打开已有文件时,先读回末尾不完整的块,保证后续整块写不会覆盖已有内容
+//
+// 文件始终截断到逻辑长度,读取时看不到填充字节
+// 文件系统不支持 O_DIRECT(如 tmpfs)时退回普通写入,direct() 返回 false
+class MINISPDLOG_API direct_file_writer {
+public:
+    // 对齐粒度:覆盖常见的 512B/4KB 逻辑块
+    static constexpr size_t alignment = 4096;
+
+    // buffer_size 向上取整到 alignment
+    direct_file_writer(const std::string& filename, bool truncate, size_t buffer_size);
+    ~direct_file_writer();
+
+    direct_file_writer(const direct_file_writer&) = delete;
+    direct_file_writer& operator=(const direct_file_writer&) = delete;
+
+    // 追加数据(缓冲区满时写出整块)
+    void write(const char* data, size_t len);
+
+    // 写出尾部(补齐到整块)并截断到逻辑长度
+    void flush();
+
+    // flush() 之后再 fdatasync(截断改变了文件长度,需要落盘)
+    void sync();
+
+    // 文件逻辑长度(包括尚在缓冲区中的数据)
+    size_t size() const;
+
+    // 是否真正绕过了页缓存
+    bool direct() const;
+
+    const std::string& filename() const;
+
+private:
+    // 写出缓冲区中所有完整的块,尾部移动到缓冲区开头
+    void write_full_blocks_();
+
+    void pwrite_all_(const char* data, size_t len, off_t offset);
+
+    std::string filename_;
+    int fd_{-1};
+    bool direct_{false};
+    char* buffer_{nullptr};        // 对齐缓冲区
+    size_t capacity_;              // 缓冲区容量(alignment 的整数倍)
+    size_t used_{0};               // 缓冲区中有效字节数
+    off_t buffer_offset_{0};       // 缓冲区第一个字节在文件中的位置(对齐)
+    bool dirty_{false};            // 上次 flush 之后是否有新数据
+};
+
+} // namespace details
+} // namespace minispdlog
+
+#endif // MINISPDLOG_WINDOWS
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "../common.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace minispdlog {
+namespace details {
+
+// histogram_snapshot: log_histogram 某一时刻的拷贝(普通整数,可随意合并、计算分位数)
+struct histogram_snapshot {
+    uint64_t count = 0;               // 样本数
+    uint64_t sum = 0;                 // 样本之和
+    uint64_t max = 0;                 // 最大样本
+    std::vector<uint64_t> buckets;    // 各桶计数(下标含义见 log_histogram)
+
+    double mean() const {
+        return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count);
+    }
+
+    // 分位数(p 取 0-1):返回所在桶的上界,不超过 max
+    uint64_t percentile(double p) const;
+
+    // 合并另一个快照(用于汇总多个工作线程/队列)
+    void merge(const histogram_snapshot& other);
+};
+
+// log_histogram: 对数-线性分桶直方图(HDR 风格)
+//
+// 分桶:
+//   - 小于 sub_buckets 的值各占一个桶
+//   - 之后每个 2 的幂区间再线性分成 sub_buckets 个桶,相对误差不超过 1/sub_buckets(12.5%)
+//   - 固定 bucket_count 个桶覆盖整个 uint64_t 范围,不需要预先知道取值范围
+//
+// 线程安全:
+//   - record() 只做 relaxed 原子加,可被多个线程同时调用,不加锁
+//   - snapshot() 逐桶读取,与 record() 并发时各字段之间可能差几个样本
+class log_histogram {
+public:
+    static constexpr int sub_bits = 3;
+    static constexpr size_t sub_buckets = size_t(1) << sub_bits;
+    static constexpr size_t bucket_count = (64 - sub_bits + 1) * sub_buckets;
+
+    void record(uint64_t value) {
+        buckets_[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        uint64_t current = max_.load(std::memory_order_relaxed);
+        while (value > current &&
+               !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    histogram_snapshot snapshot() const {
+        histogram_snapshot snap;
+        snap.count = count_.load(std::memory_order_relaxed);
+        snap.sum = sum_.load(std::memory_order_relaxed);
+        snap.max = max_.load(std::memory_order_relaxed);
+        snap.buckets.resize(bucket_count);
+        for (size_t i = 0; i < bucket_count; ++i) {
+            snap.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return snap;
+    }
+
+    // 值所在的桶
+    static size_t bucket_of(uint64_t value) {
+        if (value < sub_buckets) {
+            return static_cast<size_t>(value);
+        }
+        int shift = highest_bit_(value) - sub_bits;
+        return static_cast<size_t>(shift + 1) * sub_buckets +
+               static_cast<size_t>((value >> shift) & (sub_buckets - 1));
+    }
+
+    // 桶覆盖的最小值
+    static uint64_t bucket_lower(size_t index) {
+        if (index < sub_buckets) {
+            return index;
+        }
+        int shift = static_cast<int>(index / sub_buckets) - 1;
+        return (static_cast<uint64_t>(sub_buckets + index % sub_buckets)) << shift;
+    }
+
+    // 桶覆盖的最大值
+    static uint64_t bucket_upper(size_t index) {
+        if (index < sub_buckets) {
+            return index;
+        }
+        int shift = static_cast<int>(index / sub_buckets) - 1;
+        return bucket_lower(index) + ((uint64_t(1) << shift) - 1);
+    }
+
+private:
+    static int highest_bit_(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        int bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    std::array<std::atomic<uint64_t>, bucket_count> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+inline uint64_t histogram_snapshot::percentile(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    if (p < 0.0) {
+        p = 0.0;
+    }
+    // 第 rank 个样本(从 1 开始)所在的桶
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(count) + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    if (rank > count) {
+        rank = count;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = log_histogram::bucket_upper(i);
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+inline void histogram_snapshot::merge(const histogram_snapshot& other) {
+    count += other.count;
+    sum += other.sum;
+    if (other.max > max) {
+        max = other.max;
+    }
+    if (buckets.size() < other.buckets.size()) {
+        buckets.resize(other.buckets.size());
+    }
+    for (size_t i = 0; i < other.buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+} // namespace details
+} // namespace minispdlog
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "../common.h"
+#include "histogram.h"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace minispdlog {
+namespace details {
+
+// steady_clock 时间点转为纳秒(用于跨线程传递的时间戳)
+inline int64_t steady_ns(std::chrono::steady_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+inline int64_t steady_ns() {
+    return steady_ns(std::chrono::steady_clock::now());
+}
+
+// trace_stamps: 一条被采样的异步记录在各阶段的时间点(steady_clock 纳秒)
+// 由工作线程在栈上创建,通过 log_msg::trace 交给 sink 填写
+struct trace_stamps {
+    int64_t enqueued = 0;     // 用户线程投递
+    int64_t dequeued = 0;     // 工作线程取出
+    int64_t formatted = 0;    // 第一个 sink 开始锁内写入(此前格式化已完成)
+    int64_t written = 0;      // 最后一个 sink 写入完成
+};
+
+// latency_snapshot: 各阶段耗时直方图的快照(纳秒)
+struct latency_snapshot {
+    histogram_snapshot queue_ns;      // 投递 -> 取出:在队列中等待
+    histogram_snapshot format_ns;     // 取出 -> 开始写入:格式化及等待 sink 锁
+    histogram_snapshot write_ns;      // 开始写入 -> 写入完成:sink 锁内写入
+    histogram_snapshot total_ns;      // 投递 -> 写入完成
+
+    uint64_t samples() const {
+        return total_ns.count;
+    }
+};
+
+// latency_histograms: 按阶段记录采样结果(record 只做 relaxed 原子加,可多线程调用)
+class latency_histograms {
+public:
+    void record(const trace_stamps& t) {
+        queue_ns_.record(span_(t.enqueued, t.dequeued));
+        format_ns_.record(span_(t.dequeued, t.formatted));
+        write_ns_.record(span_(t.formatted, t.written));
+        total_ns_.record(span_(t.enqueued, t.written));
+    }
+
+    latency_snapshot snapshot() const {
+        latency_snapshot snap;
+        snap.queue_ns = queue_ns_.snapshot();
+        snap.format_ns = format_ns_.snapshot();
+        snap.write_ns = write_ns_.snapshot();
+        snap.total_ns = total_ns_.snapshot();
+        return snap;
+    }
+
+private:
+    static uint64_t span_(int64_t from, int64_t to) {
+        return to > from ? static_cast<uint64_t>(to - from) : 0;
+    }
+
+    log_histogram queue_ns_;
+    log_histogram format_ns_;
+    log_histogram write_ns_;
+    log_histogram total_ns_;
+};
+
+// 以文本写出延迟报告:
+//   - 每个阶段一行 count/mean/p50/p90/p99/p99.9/max
+//   - 之后是各阶段非零桶的明细(lower_ns,upper_ns,count),可用于重建分布
+MINISPDLOG_API void write_latency_report(std::ostream& out, const std::string& title, const latency_snapshot& snap);
+
+// 把延迟报告写入文件(覆盖),打开失败时抛出 std::runtime_error
+MINISPDLOG_API void dump_latency_report(const std::string& filename, const std::string& title,
+                                        const latency_snapshot& snap);
+
+} // namespace details
+} // namespace minispdlog
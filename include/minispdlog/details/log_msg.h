@@ -5,10 +5,13 @@
 #include "utils.h"
 #include <string>
 #include <cstddef>
+#include <cstdint>
 
 namespace minispdlog {
 namespace details {
 
+struct trace_stamps;
+
 // 源代码位置信息(用于调试)
 struct source_loc {
     constexpr source_loc() = default;
@@ -71,6 +74,12 @@ struct log_msg {
     // 颜色范围(用于格式化时着色,由 formatter 设置)
     mutable size_t color_range_start{0};
     mutable size_t color_range_end{0};
+    
+    // 端到端延迟采样(见 async_logger::set_latency_sampling)
+    // trace_start_ns: 投递时刻(steady_clock 纳秒),0 表示未被采样;随记录一起进入队列
+    // trace: 工作线程处理被采样记录时指向其时间戳,由 sink 填写写入时刻
+    int64_t trace_start_ns{0};
+    mutable trace_stamps* trace{nullptr};
 };
 
 } // namespace details
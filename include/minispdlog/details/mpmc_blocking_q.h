@@ -1,28 +1,77 @@
 #pragma once
 
 #include "circular_q.h"
+#include "histogram.h"
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include <atomic>
+#include <thread>
 
 namespace minispdlog {
 namespace details {
 
+// 消费者在队列为空时的等待方式
+enum class wait_strategy {
+    busy_poll,        // 一直自旋检查,唤醒延迟最低,空闲时占满一个核
+    spin_then_park,   // 先短暂自旋、再让出 CPU,仍为空才在条件变量上休眠
+    park_only         // 直接在条件变量上休眠(默认)
+};
+
+// 自旋等待时提示 CPU 降低功耗/让出流水线
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// queue_stats: 队列计数的快照(见 mpmc_blocking_queue::stats)
+struct queue_stats {
+    uint64_t enqueued = 0;            // 累计入队数
+    uint64_t dequeued = 0;            // 累计出队数
+    size_t depth = 0;                 // 当前长度
+    size_t high_water = 0;            // 历史最大长度
+    size_t capacity = 0;              // 容量
+    uint64_t overruns = 0;            // enqueue_nowait 覆盖的旧元素数
+    uint64_t consumer_wakeups = 0;    // 生产者发出的消费者唤醒次数
+    histogram_snapshot blocked_ns;    // 生产者在满队列上每次阻塞的时长(纳秒)
+};
+
 // mpmc_blocking_queue: 多生产者多消费者阻塞队列
 // 参考 spdlog 设计:使用 circular_q + mutex + condition_variable
 //
 // 特性:
 //   - enqueue: 队列满时阻塞
 //   - enqueue_nowait: 队列满时覆盖最旧消息
-//   - dequeue_for: 队列空时带超时阻塞
+//   - dequeue_for: 队列空时带超时阻塞(等待方式见 wait_strategy)
 //   - 线程安全
+//
+// 唤醒省略(eventcount):
+//   - 消费者在条件变量上休眠前,在锁内登记 waiting_consumers_
+//   - 生产者入队时(同一把锁内)只有休眠的消费者多于已发出、尚未被响应的唤醒(pending_wakes_)时才 notify,
+//     消费者忙于处理或已被唤醒尚未运行时,不再为每条消息产生一次 futex 系统调用
+//   - 被唤醒的消费者检查队列前先把 pending_wakes_ 减一;多个消费者共享队列时,
+//     每个休眠者最多对应一次未响应的唤醒,不会出现有数据却无人被唤醒的情况
+//   - 出队时只有生产者在等待空位才通知(waiting_producers_)
+//
+// 计数(stats()):
+//   - 计数器只在持有锁时写(普通 load + store,不需要原子加),任何线程都可以不加锁读取
+//   - 阻塞时长只在生产者真正等待时才读时钟,不影响未满时的入队路径
 template<typename T>
 class mpmc_blocking_queue {
 public:
     using item_type = T;
     
-    explicit mpmc_blocking_queue(size_t max_items)
+    // 自旋阶段:先 cpu_relax 自旋 spin_limit 次,再 yield yield_limit 次
+    static constexpr int spin_limit = 2000;
+    static constexpr int yield_limit = 50;
+    
+    explicit mpmc_blocking_queue(size_t max_items, wait_strategy strategy = wait_strategy::park_only)
         : q_(max_items)
+        , strategy_(strategy)
+        , capacity_(q_.capacity())
     {}
     
     mpmc_blocking_queue(const mpmc_blocking_queue&) = delete;
@@ -30,61 +79,275 @@ public:
     
     // 入队(阻塞模式):队列满时阻塞等待
     void enqueue(T&& item) {
+        bool wake;
         {
             std::unique_lock<std::mutex> lock(mutex_);
             // 等待队列非满
-            pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+            if (q_.full()) {
+                auto blocked_since = std::chrono::steady_clock::now();
+                ++waiting_producers_;
+                pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+                --waiting_producers_;
+                blocked_(blocked_since);
+            }
             q_.push_back(std::move(item));
+            wake = published_(lock);
+        }
+        // 只有消费者在休眠时才通知
+        if (wake) {
+            push_cv_.notify_one();
         }
-        // 通知一个等待的消费者
-        push_cv_.notify_one();
     }
     
     // 入队(非阻塞模式):队列满时覆盖最旧消息
     void enqueue_nowait(T&& item) {
+        bool wake;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (q_.full()) {
+                bump_(overruns_);
+            }
+            q_.push_back(std::move(item));
+            wake = published_(lock);
+        }
+        if (wake) {
+            push_cv_.notify_one();
+        }
+    }
+    
+    // 入队(不等待):队列满时不入队,返回 false
+    bool try_enqueue(T&& item) {
+        bool wake;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (q_.full()) {
+                return false;
+            }
+            q_.push_back(std::move(item));
+            wake = published_(lock);
+        }
+        if (wake) {
+            push_cv_.notify_one();
+        }
+        return true;
+    }
+    
+    // 入队(带超时):队列满时最多等待 timeout,仍然满则不入队,返回 false
+    bool enqueue_for(T&& item, std::chrono::milliseconds timeout) {
+        bool wake;
         {
             std::unique_lock<std::mutex> lock(mutex_);
+            if (q_.full()) {
+                auto blocked_since = std::chrono::steady_clock::now();
+                ++waiting_producers_;
+                bool ready = pop_cv_.wait_for(lock, timeout, [this] { return !this->q_.full(); });
+                --waiting_producers_;
+                blocked_(blocked_since);
+                if (!ready) {
+                    return false;
+                }
+            }
             q_.push_back(std::move(item));
+            wake = published_(lock);
+        }
+        if (wake) {
+            push_cv_.notify_one();
+        }
+        return true;
+    }
+    
+    // 打断消费者的等待:正在(或下一次)dequeue_for 中等待的消费者在队列为空时立即返回 false
+    // 标志保持到被某个消费者观察到为止,因此在消费者开始等待之前调用也不会丢失
+    // 用于让工作线程转去检查其他队列(如线程池的优先通道)
+    void interrupt() {
+        if (interrupted_.load(std::memory_order_relaxed)) {
+            return;  // 上一次打断尚未被观察到
+        }
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            interrupted_.store(true, std::memory_order_relaxed);
+            wake = waiting_consumers_ > 0;
+        }
+        if (wake) {
+            push_cv_.notify_all();
+        }
+    }
+    
+    // 出队(不等待):队列为空时返回 false
+    bool try_dequeue(T& popped_item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (q_.empty()) {
+            return false;
         }
-        push_cv_.notify_one();
+        popped_item = std::move(q_.front());
+        q_.pop_front();
+        popped_();
+        
+        bool wake = waiting_producers_ > 0;
+        lock.unlock();
+        if (wake) {
+            pop_cv_.notify_one();
+        }
+        return true;
     }
     
     // 出队(带超时):成功返回 true,超时返回 false
     // wait_duration: 最长等待时间
     bool dequeue_for(T& popped_item, std::chrono::milliseconds wait_duration) {
+        auto deadline = std::chrono::steady_clock::now() + wait_duration;
+        
+        // 先在锁外观察 size_hint_,避免空队列时反复加锁
+        if (strategy_ != wait_strategy::park_only && !spin_until_nonempty_(deadline)) {
+            return false;  // busy_poll 超时
+        }
+        
         std::unique_lock<std::mutex> lock(mutex_);
         
-        // 等待队列非空或超时
-        if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); })) {
-            return false;  // 超时
+        // 等待队列非空、超时或被 interrupt() 打断
+        if (q_.empty()) {
+            ++waiting_consumers_;
+            push_cv_.wait_until(lock, deadline, [this] {
+                if (pending_wakes_ > 0) {
+                    --pending_wakes_;
+                }
+                return !this->q_.empty() || interrupted_.load(std::memory_order_relaxed);
+            });
+            --waiting_consumers_;
+            if (q_.empty()) {
+                interrupted_.store(false, std::memory_order_relaxed);
+                return false;  // 超时或被打断
+            }
         }
         
         popped_item = std::move(q_.front());
         q_.pop_front();
+        popped_();
         
-        // 通知一个等待的生产者
-        pop_cv_.notify_one();
+        // 只有生产者在等待空位时才通知
+        bool wake = waiting_producers_ > 0;
+        lock.unlock();
+        if (wake) {
+            pop_cv_.notify_one();
+        }
         
         return true;
     }
     
+    // 生产者实际发出的唤醒次数(消费者忙碌时被省略的不计入)
+    size_t consumer_wakeups() const {
+        return consumer_wakeups_.load(std::memory_order_relaxed);
+    }
+    
+    wait_strategy strategy() const {
+        return strategy_;
+    }
+    
     // 获取溢出计数(被覆盖的消息数)
-    size_t overrun_counter() {
-        std::unique_lock<std::mutex> lock(mutex_);
-        return q_.overrun_counter();
+    size_t overrun_counter() const {
+        return overruns_.load(std::memory_order_relaxed);
     }
     
-    // 当前队列大小
-    size_t size() {
-        std::unique_lock<std::mutex> lock(mutex_);
-        return q_.size();
+    // 当前队列大小(不加锁,读取入队/出队时更新的快照)
+    size_t size() const {
+        return size_hint_.load(std::memory_order_relaxed);
+    }
+    
+    // 计数快照(不加锁)
+    queue_stats stats() const {
+        queue_stats st;
+        st.enqueued = enqueued_.load(std::memory_order_relaxed);
+        st.dequeued = dequeued_.load(std::memory_order_relaxed);
+        st.depth = size_hint_.load(std::memory_order_relaxed);
+        st.high_water = high_water_.load(std::memory_order_relaxed);
+        st.capacity = capacity_;
+        st.overruns = overruns_.load(std::memory_order_relaxed);
+        st.consumer_wakeups = consumer_wakeups_.load(std::memory_order_relaxed);
+        st.blocked_ns = blocked_ns_.snapshot();
+        return st;
     }
     
 private:
+    // 入队后调用(持有锁):更新 size_hint_,返回是否需要唤醒消费者
+    bool published_(std::unique_lock<std::mutex>&) {
+        size_t size = q_.size();
+        size_hint_.store(size, std::memory_order_relaxed);
+        bump_(enqueued_);
+        if (size > high_water_.load(std::memory_order_relaxed)) {
+            high_water_.store(size, std::memory_order_relaxed);
+        }
+        if (waiting_consumers_ <= pending_wakes_) {
+            return false;
+        }
+        ++pending_wakes_;
+        bump_(consumer_wakeups_);
+        return true;
+    }
+    
+    // 出队后调用(持有锁)
+    void popped_() {
+        size_hint_.store(q_.size(), std::memory_order_relaxed);
+        bump_(dequeued_);
+    }
+    
+    // 生产者结束一次阻塞等待(持有锁)
+    void blocked_(std::chrono::steady_clock::time_point since) {
+        auto blocked = std::chrono::steady_clock::now() - since;
+        blocked_ns_.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(blocked).count()));
+    }
+    
+    // 持有锁时递增计数:只有一个写者,不需要原子读-改-写
+    static void bump_(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    
+    // 自旋等待队列非空;返回 false 表示 busy_poll 到达截止时间
+    // spin_then_park 自旋结束后返回 true,由调用者加锁检查并在需要时休眠
+    bool spin_until_nonempty_(std::chrono::steady_clock::time_point deadline) {
+        for (int i = 0; ; ++i) {
+            if (size_hint_.load(std::memory_order_relaxed) > 0 ||
+                interrupted_.load(std::memory_order_relaxed)) {
+                return true;
+            }
+            if (strategy_ == wait_strategy::spin_then_park) {
+                if (i >= spin_limit + yield_limit) {
+                    return true;
+                }
+                if (i < spin_limit) {
+                    cpu_relax();
+                } else {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+            // busy_poll:每 1024 次检查一次截止时间
+            cpu_relax();
+            if ((i & 1023) == 1023 && std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+        }
+    }
+    
     std::mutex mutex_;                      // 保护队列
     std::condition_variable push_cv_;       // 通知消费者:有新元素
     std::condition_variable pop_cv_;        // 通知生产者:有空闲槽位
     circular_q<T> q_;                       // 循环队列
+    wait_strategy strategy_;                // 消费者等待方式
+    std::atomic<size_t> size_hint_{0};      // 队列长度(锁外自旋时读取)
+    size_t waiting_consumers_{0};           // 在 push_cv_ 上休眠的消费者数(受 mutex_ 保护)
+    size_t waiting_producers_{0};           // 在 pop_cv_ 上等待的生产者数(受 mutex_ 保护)
+    size_t pending_wakes_{0};               // 已发出、消费者尚未响应的唤醒数(受 mutex_ 保护)
+    std::atomic<bool> interrupted_{false};  // interrupt() 设置,被等待中的消费者观察到后清除
+    
+    // 计数(只在持有 mutex_ 时写,可不加锁读)
+    const size_t capacity_;                         // 容量
+    std::atomic<uint64_t> enqueued_{0};             // 累计入队数
+    std::atomic<uint64_t> dequeued_{0};             // 累计出队数
+    std::atomic<size_t> high_water_{0};             // 历史最大长度
+    std::atomic<uint64_t> overruns_{0};             // 覆盖的旧元素数
+    std::atomic<uint64_t> consumer_wakeups_{0};     // 实际发出的消费者唤醒次数
+    log_histogram blocked_ns_;                      // 生产者每次阻塞的时长
 };
 
 } // namespace details
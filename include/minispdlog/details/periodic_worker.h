@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../common.h"
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace minispdlog {
+namespace details {
+
+// periodic_worker: 按固定间隔执行回调的后台线程
+// 用于 registry::flush_every() 的周期性刷新
+//
+// 特性:
+//   - 间隔期间在条件变量上等待,析构时立即唤醒并退出,不必等满一个周期
+//   - 回调抛出的异常被吞掉(后台线程无处上报)
+class MINISPDLOG_API periodic_worker {
+public:
+    periodic_worker(std::function<void()> callback, std::chrono::milliseconds interval);
+    ~periodic_worker();
+    
+    periodic_worker(const periodic_worker&) = delete;
+    periodic_worker& operator=(const periodic_worker&) = delete;
+    
+private:
+    void worker_loop_();
+    
+    std::function<void()> callback_;
+    std::chrono::milliseconds interval_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_{false};
+    std::thread thread_;        // 最后初始化,保证线程启动时其他成员已就绪
+};
+
+} // namespace details
+} // namespace minispdlog
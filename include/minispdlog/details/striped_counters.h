@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../common.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace minispdlog {
+namespace details {
+
+// 当前线程使用的分片序号:线程第一次调用时按轮转分配,之后固定不变
+inline size_t this_thread_stripe() {
+    static std::atomic<size_t> next{0};
+    static thread_local const size_t stripe = next.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+
+// striped_counters: N 个计数器的按线程分片版本
+//
+// 用途:logger 的热路径计数(每条日志都要加),避免所有线程争用同一条缓存行
+//   - stripes 个分片各占独立的缓存行,每个线程固定使用其中一个(this_thread_stripe)
+//   - 线程数不超过 stripes 时每个分片只有一个写者,relaxed 加法不会引起缓存行迁移
+//   - 线程更多时多个线程共用一个分片,仍然正确,只是重新出现少量争用
+//   - sum() 逐分片读取后求和,与写入并发时结果是近似快照
+template<size_t N>
+class striped_counters {
+public:
+    static constexpr size_t stripes = 16;
+
+    using stripe_type = std::array<std::atomic<uint64_t>, N>;
+
+    // 当前线程的分片:一次调用内更新多个计数器时只查找一次
+    stripe_type& local() {
+        return stripes_[this_thread_stripe() % stripes].values;
+    }
+
+    void add(size_t index, uint64_t value) {
+        local()[index].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    std::array<uint64_t, N> sum() const {
+        std::array<uint64_t, N> total{};
+        for (auto& s : stripes_) {
+            for (size_t i = 0; i < N; ++i) {
+                total[i] += s.values[i].load(std::memory_order_relaxed);
+            }
+        }
+        return total;
+    }
+
+private:
+    struct alignas(64) stripe {
+        stripe_type values{};
+    };
+
+    std::array<stripe, stripes> stripes_{};
+};
+
+} // namespace details
+} // namespace minispdlog
@@ -3,10 +3,17 @@
 #include "../common.h"
 #include "mpmc_blocking_q.h"
 #include "async_msg.h"
+#include "latency.h"
+#include "../flush_ticket.h"
 #include <thread>
 #include <vector>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <string>
+#include <condition_variable>
 
 namespace minispdlog {
 
@@ -15,6 +22,89 @@ class async_logger;
 
 namespace details {
 
+// 工作线程调度策略
+enum class worker_sched {
+    normal,     // SCHED_OTHER,可配合 nice
+    idle,       // SCHED_IDLE:只在 CPU 空闲时运行,不抢占业务线程(仅 Linux)
+    fifo        // SCHED_FIFO 实时优先级(需要 CAP_SYS_NICE)
+};
+
+// thread_pool_options: 线程池配置
+struct thread_pool_options {
+    size_t queue_size = 8192;   // 队列容量(分片模式下为每个工作线程的队列容量)
+    size_t threads_n = 1;       // 工作线程数量
+    
+    // 分片模式:每个工作线程一个独立队列,每个 async_logger 固定由其中一个线程处理
+    //   - 默认按 logger 名称哈希分配,可用 async_logger::pin_to_worker 显式指定
+    //   - 同一 logger 的消息保持顺序,其 sink 只被一个工作线程访问
+    // 非分片模式:所有工作线程共享一个队列(threads_n > 1 时同一 logger 的消息可能乱序,
+    //   且不支持 flush_durable:无法确认其他线程已取出的消息是否已写出)
+    bool sharded = false;
+    
+    // 队列为空时工作线程的等待方式(见 wait_strategy);
+    // 各方式下生产者都只在工作线程休眠时才发出唤醒
+    wait_strategy wait = wait_strategy::park_only;
+    
+    // 优先通道:级别 >= priority_level 的日志进入每个队列旁的独立小队列
+    //   - 工作线程每取一条消息前先检查优先通道,投递时会打断工作线程在普通队列上的等待
+    //   - 普通队列满(block 策略下生产者阻塞)不影响优先通道的投递
+    //   - 优先记录可能先于同一 logger 更早的普通记录输出
+    // level::off 表示不启用
+    level priority_level = level::off;
+    size_t priority_queue_size = 1024;          // 优先通道容量(每个队列一个)
+    
+    // ---- 工作线程放置:在每个线程启动时应用,实际结果见 thread_pool::workers_info() ----
+    std::vector<int> cpu_affinity;              // 允许运行的 CPU 列表,空表示不限制
+    bool pin_each_worker = false;               // true 时第 i 个线程只绑定 cpu_affinity[i % size]
+    worker_sched sched = worker_sched::normal;  // 调度策略
+    int nice = 0;                               // normal/idle 下的 nice 值(Linux 上按线程生效)
+    int fifo_priority = 1;                      // fifo 下的实时优先级(1-99)
+    std::string thread_name = "minispdlog";     // 线程名前缀,实际为 "<前缀>-<序号>"(Linux 截断到 15 字节)
+    int numa_node = -1;                         // 队列内存及工作线程内存优先分配的 NUMA 节点,-1 表示不指定(仅 Linux)
+};
+
+// worker_info: 一个工作线程实际生效的放置结果
+// 设置失败(如没有权限使用 SCHED_FIFO)不会抛出异常,而是记录在 errors 中
+struct worker_info {
+    size_t index = 0;                           // 工作线程序号
+    std::string name;                           // 线程名
+    long tid = 0;                               // 内核线程 ID(仅 Linux,其他平台为 0)
+    std::vector<int> cpus;                      // 实际的 CPU 亲和性(读回的结果)
+    worker_sched sched = worker_sched::normal;  // 实际的调度策略
+    int priority = 0;                           // normal/idle 为 nice 值,fifo 为实时优先级
+    int numa_node = -1;                         // 内存策略指向的节点,-1 表示未设置
+    int start_cpu = -1;                         // 启动时所在 CPU
+    int start_node = -1;                        // 启动时所在 NUMA 节点
+    std::string errors;                         // 未能应用的设置,空表示全部生效
+};
+
+// worker_stats: 一个工作线程的计数快照
+struct worker_stats {
+    size_t index = 0;                 // 工作线程序号
+    uint64_t processed = 0;           // 处理的消息数
+    uint64_t busy_ns = 0;             // 处理消息(调用 sink)的时间
+    uint64_t idle_ns = 0;             // 在队列上取消息(含等待)的时间
+    histogram_snapshot batch_sizes;   // 每次队列由空变为非空后连续处理的消息数
+};
+
+// thread_pool_stats: thread_pool::stats() 返回的快照
+// 各字段分别读取,与投递并发时彼此之间可能相差几条消息
+struct thread_pool_stats {
+    std::vector<queue_stats> queues;            // 每个分片的普通队列(非分片模式只有 1 个)
+    std::vector<queue_stats> priority_queues;   // 每个分片的优先通道(未启用时为空)
+    std::vector<worker_stats> workers;          // 每个工作线程
+    
+    // 汇总(普通队列 + 优先通道)
+    uint64_t enqueued = 0;            // 累计入队数
+    uint64_t dequeued = 0;            // 累计出队数
+    size_t depth = 0;                 // 当前积压
+    size_t high_water = 0;            // 单个队列的历史最大长度
+    uint64_t overruns = 0;            // overrun_oldest 覆盖的消息数
+    uint64_t discarded = 0;           // discard_new / block_with_timeout 丢弃的消息数
+    uint64_t caller_runs = 0;         // caller_runs 由生产者直接写入的消息数
+    histogram_snapshot blocked_ns;    // 生产者每次在满队列上阻塞的时长(纳秒)
+};
+
 // thread_pool: 异步日志的线程池
 // 参考 spdlog 设计:管理工作线程 + MPMC 队列
 //
@@ -31,6 +121,9 @@ public:
     // threads_n: 工作线程数量
     thread_pool(size_t queue_size, size_t threads_n);
     
+    // 按配置构造(可选分片模式)
+    explicit thread_pool(const thread_pool_options& options);
+    
     // 禁止拷贝
     thread_pool(const thread_pool&) = delete;
     thread_pool& operator=(const thread_pool&) = delete;
@@ -44,21 +137,183 @@ public:
     // 投递日志消息(非阻塞模式,队列满时覆盖)
     void post_log_nowait(std::shared_ptr<async_logger> &&async_logger_ptr, const log_msg& msg);
     
-    // 投递刷新请求
-    void post_flush(std::shared_ptr<async_logger> &&async_logger_ptr);
+    // 投递日志消息(不等待):队列满时丢弃该消息,返回 false
+    // dropped_before: 此前被丢弃的消息数,后台线程在这条消息之前输出 "N messages dropped"
+    bool try_post_log(std::shared_ptr<async_logger> &&async_logger_ptr, const log_msg& msg,
+                      size_t dropped_before = 0);
+    
+    // 投递日志消息(限时等待):队列满时最多等待 timeout,超时后丢弃,返回 false
+    bool post_log_for(std::shared_ptr<async_logger> &&async_logger_ptr, const log_msg& msg,
+                      std::chrono::milliseconds timeout, size_t dropped_before = 0);
+    
+    // 投递日志消息(调用者执行):队列满时由调用线程直接把这条记录写入该 logger 自己的 sink
+    // (经过各 sink 的锁),不会休眠,也不丢消息;不会碰其他 logger 的记录和 sink
+    // 注意:
+    //   - 直接写入的记录会先于该 logger 仍在队列中的记录输出
+    //   - 要求该 logger 的所有 sink 都是线程安全的(sink::thread_safe());否则退回阻塞入队
+    //   - 不能用于分片模式(async_logger 构造时拒绝),否则会破坏每个 sink 只被一个线程访问的保证
+    void post_log_caller_runs(std::shared_ptr<async_logger> &&async_logger_ptr, const log_msg& msg);
+    
+    // 投递刷新请求(dropped_before 同 try_post_log,在刷新前报告)
+    void post_flush(std::shared_ptr<async_logger> &&async_logger_ptr, size_t dropped_before = 0);
     
-    // 获取溢出计数
+    // 投递合并的批量刷新请求(registry::flush_every 使用)
+    // 队列中已有一个未处理的批量刷新时,只替换待刷新列表,不再入队
+    // 返回是否真正入队了一条消息
+    bool post_flush_all(std::vector<std::shared_ptr<async_logger>> loggers);
+    
+    // 投递持久化刷新请求(group commit)
+    // 工作线程取出请求后并不立即 sync,而是等到队列排空(或累计处理了
+    // max_sync_delay_msgs 条消息)时,对本批涉及的每个 sink 只调用一次 sync()
+    // 每个队列各自成批,只由该队列的工作线程提交,不会触碰其他分片的 sink
+    // 非分片且 threads_n > 1 时抛出 std::runtime_error:sync 请求之前的消息可能还在
+    // 其他工作线程手里尚未写出,提交后的凭据无法保证这些消息已落盘
+    flush_ticket post_sync(std::shared_ptr<async_logger> &&async_logger_ptr);
+    
+    // 已执行的 sync 批次数(每批每个 sink 一次 fdatasync)
+    size_t sync_commits() const;
+    
+    // 获取溢出计数(所有队列之和)
     size_t overrun_counter();
     
+    // discard_new / block_with_timeout 策略下被丢弃的消息数
+    size_t discard_counter() const;
+    
+    // caller_runs 策略下由生产者线程代为处理的消息数
+    size_t caller_runs_counter() const;
+    
+    // 生产者实际发出的唤醒次数(所有队列之和)
+    size_t consumer_wakeups();
+    
+    // 工作线程数量
+    size_t threads_n() const;
+    
+    // 是否为分片模式
+    bool sharded() const;
+    
+    // 进入优先通道的最低级别(未启用时为 level::off)
+    level priority_level() const;
+    
+    // 进入优先通道的消息数
+    size_t priority_counter() const;
+    
+    // 优先通道的溢出(覆盖)计数
+    size_t priority_overrun_counter();
+    
+    // 优先通道中被 discard_new / block_with_timeout 丢弃的消息数(也计入 discard_counter)
+    size_t priority_discard_counter() const;
+    
+    // 处理该 logger 消息的工作线程序号(非分片模式下所有线程共享队列,返回 0)
+    size_t worker_for(const async_logger& logger) const;
+    
+    // 每个工作线程实际生效的放置(CPU 亲和性、调度策略、线程名、NUMA 节点)
+    std::vector<worker_info> workers_info() const;
+    
+    // 队列与工作线程的计数快照(不加锁,可随时调用)
+    thread_pool_stats stats() const;
+    
+    // 本线程池处理的所有被采样记录的各阶段延迟(见 async_logger::set_latency_sampling)
+    latency_snapshot latency() const;
+    
+    // 把 latency() 写成文本报告(格式见 write_latency_report),失败时抛出异常
+    void dump_latency(const std::string& filename) const;
+    
 private:
+    // 一个队列及其上的合并刷新状态;非分片模式只有一个
+    struct shard {
+        explicit shard(const thread_pool_options& options)
+            : q(options.queue_size, options.wait)
+        {
+            if (options.priority_level != level::off) {
+                priority_q = std::make_unique<q_type>(options.priority_queue_size);
+            }
+        }
+        
+        q_type q;                                                   // MPMC 队列
+        std::unique_ptr<q_type> priority_q;                         // 优先通道(未启用时为空)
+        std::mutex flush_mutex;
+        std::vector<std::shared_ptr<async_logger>> pending_flush;   // 待刷新的 logger
+        std::atomic<bool> flush_pending{false};                     // 队列中是否已有 flush_all
+        
+        // 持久化刷新批次:只由本队列唯一的工作线程访问,不加锁
+        std::vector<std::promise<void>> sync_batch;                 // 当前批次的等待者
+        std::vector<std::shared_ptr<async_logger>> sync_loggers;    // 当前批次涉及的 logger(非空表示有批次)
+        size_t sync_age{0};                                         // 批次开始后处理的消息数
+    };
+    
+    // 该 logger 的消息应投递到的队列
+    shard& shard_for_(const async_logger& logger) const;
+    
+    // 该消息应进入的通道(优先通道或普通队列)
+    q_type& lane_for_(shard& s, const log_msg& msg) const;
+    
+    // 成功投递到 lane 之后调用:进入优先通道时计数并打断工作线程在普通队列上的等待
+    void posted_to_(shard& s, q_type& lane);
+    
+    // 投递到 lane 失败(被丢弃)时调用
+    void discarded_from_(shard& s, q_type& lane);
+    
+    // 工作线程启动时应用放置设置,记录到 workers_
+    void apply_placement_(size_t index);
+    
+    // 工作线程的计数(只由该线程写)
+    struct alignas(64) worker_counters {
+        std::atomic<uint64_t> processed{0};
+        std::atomic<uint64_t> busy_ns{0};
+        std::atomic<uint64_t> idle_ns{0};
+        log_histogram batch_sizes;
+    };
+    
     // 工作线程主循环
-    void worker_loop_();
+    void worker_loop_(shard& s, worker_counters& counters);
     
-    // 处理下一条消息(返回 false 表示应该退出)
-    bool process_next_msg_();
+    // 取出下一条消息:先优先通道,再普通队列(超时或被打断时返回 false)
+    bool next_msg_(shard& s, async_msg& msg);
     
-    q_type q_;                          // MPMC 队列
-    std::vector<std::thread> threads_;  // 工作线程
+    // 处理一条已取出的消息(返回 false 表示应该退出)
+    bool handle_msg_(shard& s, async_msg& msg);
+    
+    // 输出一条被采样的日志消息,并把各阶段耗时记入 logger 和线程池的直方图
+    void trace_log_(async_msg& msg);
+    
+    
+    // 执行批量刷新(工作线程调用)
+    void process_flush_all_(shard& s);
+    
+    // 把一条 sync 请求加入本队列的当前批次(本队列的工作线程调用)
+    void add_to_sync_batch_(shard& s, async_msg& msg);
+    
+    // 提交本队列的当前批次:每个 sink 一次 sync(),然后唤醒本批所有等待者
+    void commit_sync_batch_(shard& s);
+    
+    // 队列持续不空时,一批 sync 最多推迟这么多条消息
+    static constexpr size_t max_sync_delay_msgs = 1024;
+    
+    std::vector<std::unique_ptr<shard>> shards_;  // 非分片模式 1 个,分片模式每个工作线程 1 个
+    std::vector<std::thread> threads_;            // 工作线程
+    std::vector<std::unique_ptr<worker_counters>> counters_;  // 每个工作线程的计数
+    
+    // 工作线程放置
+    thread_pool_options options_;
+    mutable std::mutex workers_mutex_;
+    std::condition_variable workers_cv_;
+    std::vector<worker_info> workers_;            // 每个线程启动后填入
+    size_t workers_started_{0};
+    
+    // 持久化刷新(group commit)
+    std::atomic<uint64_t> sync_seq_{0};                                // 最近分配的 sync 序号
+    std::atomic<size_t> sync_commits_{0};                              // 已提交的批次数
+    
+    // 溢出策略统计
+    std::atomic<size_t> discarded_{0};                                 // 队列满时丢弃的消息数
+    std::atomic<size_t> caller_ran_{0};                                // 生产者直接写入的消息数
+    
+    // 端到端延迟采样
+    latency_histograms latency_;                                       // 所有 logger 的采样汇总
+    
+    // 优先通道统计
+    std::atomic<size_t> priority_posted_{0};                           // 进入优先通道的消息数
+    std::atomic<size_t> priority_discarded_{0};                        // 优先通道丢弃的消息数
 };
 
 } // namespace details
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "../common.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#ifdef MINISPDLOG_LINUX
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace minispdlog {
+namespace details {
+
+// uring_file_writer: 基于 io_uring 的多缓冲文件写入器(仅 Linux)
+//
+// 工作方式:
+//   - 预分配 buffer_count 个页对齐缓冲区,并注册给 io_uring(IORING_REGISTER_BUFFERS)
+//   - 记录先追加到当前缓冲区;写满后以 WRITE_FIXED 提交到显式文件偏移,切换到下一个缓冲区
+//   - 只有下一个缓冲区仍在写入中时才需要等待(stall),双/三缓冲让调用者继续格式化
+//   - flush() 提交剩余数据并等待全部完成;fsync_on_flush 时再提交一个 IO_DRAIN 的 fdatasync
+//
+// 回退:
+//   - io_uring_setup 失败(内核不支持、被 seccomp 禁止等)时退回到同步 pwrite
+//   - 建环后用 IORING_REGISTER_PROBE 探测操作码(探测本身不支持的旧内核上,这里用到的操作码都已存在):
+//     WRITE_FIXED 不支持或缓冲区注册失败时改用 IORING_OP_WRITEV,两者都不可用时退回 pwrite;
+//     FSYNC 不支持时等写入完成后同步调用 fdatasync
+class MINISPDLOG_API uring_file_writer {
+public:
+    uring_file_writer(
+        const std::string& filename,
+        bool truncate,
+        size_t buffer_size,
+        size_t buffer_count,
+        bool fsync_on_flush
+    );
+    ~uring_file_writer();
+
+    uring_file_writer(const uring_file_writer&) = delete;
+    uring_file_writer& operator=(const uring_file_writer&) = delete;
+
+    // 追加数据(可能触发一次提交)
+    void write(const char* data, size_t len);
+
+    // 提交剩余数据并等待全部写入完成
+    void flush();
+
+    // 与 flush() 相同,但无论 fsync_on_flush 如何都追加一个 fdatasync
+    void sync();
+
+    // 是否真正使用了 io_uring(false 表示已回退到 pwrite)
+    bool using_io_uring() const;
+
+    // 因下一个缓冲区仍在写入而等待的次数
+    size_t buffer_waits() const;
+
+private:
+    struct buffer {
+        char* data{nullptr};
+        size_t used{0};
+        off_t offset{0};
+        bool in_flight{false};
+    };
+
+    // 建立 io_uring,失败时返回 false
+    bool setup_ring_(unsigned entries);
+    void teardown_ring_();
+
+    // 探测内核支持的操作码,结果写入 *_supported_
+    void probe_ops_();
+
+    // flush()/sync() 的实现
+    void commit_(bool datasync);
+
+    // 提交当前缓冲区,并切换到下一个空闲缓冲区
+    void submit_current_();
+
+    // 收割完成事件;wait=true 时至少等待一个
+    void reap_(bool wait);
+
+    // 等待所有在途操作完成
+    void wait_all_();
+
+    // 获取一个 SQE 并提交给内核
+    io_uring_sqe* next_sqe_();
+    void enter_(unsigned to_submit, unsigned min_complete);
+
+    // 同步写入(回退路径、短写补齐、超大记录)
+    void pwrite_all_(const char* data, size_t len, off_t offset);
+
+    std::string filename_;
+    int fd_{-1};
+    off_t file_offset_{0};             // 下一个提交的缓冲区落在文件中的位置
+    size_t buffer_size_;
+    bool fsync_on_flush_;
+    std::vector<buffer> buffers_;
+    std::vector<struct iovec> iovecs_;
+    size_t current_{0};                // 正在填充的缓冲区
+    size_t buffer_waits_{0};
+    unsigned in_flight_ops_{0};
+
+    // io_uring 环
+    int ring_fd_{-1};
+    bool buffers_registered_{false};
+    bool write_fixed_supported_{true};
+    bool writev_supported_{true};
+    bool fsync_supported_{true};
+    void* sq_ptr_{nullptr};
+    void* cq_ptr_{nullptr};
+    size_t sq_map_size_{0};
+    size_t cq_map_size_{0};
+    io_uring_sqe* sqes_{nullptr};
+    size_t sqes_map_size_{0};
+    unsigned* sq_tail_{nullptr};
+    unsigned* sq_mask_{nullptr};
+    unsigned* sq_array_{nullptr};
+    unsigned* cq_head_{nullptr};
+    unsigned* cq_tail_{nullptr};
+    unsigned* cq_mask_{nullptr};
+    io_uring_cqe* cqes_{nullptr};
+};
+
+} // namespace details
+} // namespace minispdlog
+
+#endif // MINISPDLOG_LINUX
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "common.h"
+#include <cstdint>
+#include <future>
+#include <chrono>
+
+namespace minispdlog {
+
+// flush_ticket: 持久化刷新(logger::flush_durable)的完成凭据
+//
+// 异步 logger:
+//   - sequence() 是该请求在线程池中的 sync 序号(单调递增)
+//   - 后台线程把同一批内所有未完成的请求合并成每个 sink 一次 fdatasync(group commit),
+//     提交后该批所有凭据一起就绪
+//   - 多个工作线程共享一个队列(非分片)时不支持,flush_durable() 抛出异常
+// 同步 logger:
+//   - flush_durable() 返回时已经完成,sequence() 为 0
+class flush_ticket {
+public:
+    flush_ticket(uint64_t seq, std::shared_future<void> done)
+        : seq_(seq)
+        , done_(std::move(done))
+    {}
+
+    // 请求序号
+    uint64_t sequence() const {
+        return seq_;
+    }
+
+    // 等待数据落盘;sync 失败时在这里重新抛出异常,
+    // 请求在队列中被 overrun_oldest 覆盖时抛出 std::future_error(broken_promise)
+    void wait() const {
+        done_.get();
+    }
+
+    // 带超时等待,返回是否已完成
+    template<typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+        return done_.wait_for(timeout) == std::future_status::ready;
+    }
+
+    // 是否已完成(不阻塞)
+    bool ready() const {
+        return wait_for(std::chrono::seconds(0));
+    }
+
+private:
+    uint64_t seq_;
+    std::shared_future<void> done_;
+};
+
+} // namespace minispdlog
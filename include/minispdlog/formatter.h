@@ -20,6 +20,18 @@ public:
     // 创建 formatter 的副本
     // 每个 sink 需要独立的 formatter 实例,避免多线程竞争
     virtual std::unique_ptr<formatter> clone() const = 0;
+    
+    // 是否允许多个线程同时调用 format()
+    // 返回 true 时多线程 sink 会在锁外格式化(见 sinks::base_sink)
+    virtual bool thread_safe() const {
+        return false;
+    }
+    
+    // 对任意消息是否与 other 产生完全相同的输出
+    // logger 据此让多个 sink 共用一次格式化结果(见 logger::log_to_sinks_)
+    virtual bool equivalent(const formatter& other) const {
+        return this == &other;
+    }
 };
 
 } // namespace minispdlog
\ No newline at end of file
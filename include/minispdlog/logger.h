@@ -4,7 +4,10 @@
 #include "level.h"
 #include "sinks/base_sink.h"
 #include "details/log_msg.h"
+#include "flush_ticket.h"
+#include "details/striped_counters.h"
 #include <fmt/format.h>
+#include <array>
 #include <vector>
 #include <memory>
 #include <string>
@@ -12,6 +15,24 @@
 
 namespace minispdlog {
 
+// logger_stats: logger 的计数快照(见 logger::stats)
+struct logger_stats {
+    std::string name;
+    std::array<uint64_t, 7> messages{};         // 按级别(下标为 level 的值)通过级别过滤的消息数
+    uint64_t filtered = 0;                      // 低于 logger 级别、被直接丢弃的调用数
+    uint64_t bytes = 0;                         // 格式化出的 payload 字节数
+    std::vector<sinks::sink_stats> sinks;       // 与 sinks() 顺序一致
+    
+    // 通过级别过滤的消息总数
+    uint64_t total() const {
+        uint64_t n = 0;
+        for (uint64_t m : messages) {
+            n += m;
+        }
+        return n;
+    }
+};
+
 // logger 类:日志记录器的核心实现
 // 参考 spdlog 设计:
 // 1. 持有多个 sink,每次日志调用会遍历所有 sink
@@ -70,22 +91,43 @@ public:
     template<typename... Args>
     void log(level lvl, fmt::format_string<Args...> fmt, Args&&... args) {
         if (!should_log(lvl)) {
+            counters_.add(counter_filtered_, 1);
             return;
         }
         
         // 格式化消息
         fmt::memory_buffer buf;
         fmt::format_to(std::back_inserter(buf), fmt, std::forward<Args>(args)...);
+        log_payload_(lvl, buf);
+    }
+    
+    // 调用点限流版本(由 rate_limit.h 中的 MINISPDLOG_LOG_EVERY_N 等宏调用)
+    // site.allow(suppressed) 在级别过滤之后、格式化之前决定是否放行;
+    // 放行时 suppressed 为此前被抑制的次数,非零时以 " (N suppressed)" 附加到这条记录末尾
+    // 格式化抛出异常时调用 site.restore(suppressed) 归还抑制计数(及可归还的放行名额)后重新抛出
+    template<typename Site, typename... Args>
+    void log_limited(Site&& site, level lvl, fmt::format_string<Args...> fmt, Args&&... args) {
+        if (!should_log(lvl)) {
+            counters_.add(counter_filtered_, 1);
+            return;
+        }
         
-        // 创建 log_msg
-        details::log_msg msg(
-            name_,
-            lvl,
-            string_view_t(buf.data(), buf.size())
-        );
+        uint64_t suppressed = 0;
+        if (!site.allow(suppressed)) {
+            return;
+        }
         
-        // 输出到所有 sink
-        sink_it_(msg);
+        fmt::memory_buffer buf;
+        try {
+            fmt::format_to(std::back_inserter(buf), fmt, std::forward<Args>(args)...);
+            if (suppressed != 0) {
+                fmt::format_to(std::back_inserter(buf), " ({} suppressed)", suppressed);
+            }
+        } catch (...) {
+            site.restore(suppressed);
+            throw;
+        }
+        log_payload_(lvl, buf);
     }
     
     // ========== Sink 管理 ==========
@@ -106,14 +148,46 @@ public:
     void flush();
     void flush_on(level log_level);
     
+    // 持久化刷新:对每个 sink 调用 sync()(文件 sink 会 fdatasync)
+    // 同步 logger 返回时已完成;异步 logger 返回凭据,由后台线程批量提交
+    flush_ticket flush_durable();
+    
     // ========== 名称 ==========
     
     const std::string& name() const;
     
+    // ========== 计数 ==========
+    
+    // 本 logger 及其各 sink 的计数快照
+    // 热路径只更新调用线程自己的分片(见 details::striped_counters),这里求和
+    logger_stats stats() const;
+    
 protected:
     // 将消息输出到所有 sink
     virtual void sink_it_(const details::log_msg& msg);
     virtual void flush_();
+    virtual flush_ticket flush_durable_();
+    
+    // 把消息交给所有 sink(同步 sink_it_ 与异步后台线程共用)
+    // formatter 等价的 sink 只格式化一次,之后各自 log_formatted 写入
+    void log_to_sinks_(const details::log_msg& msg);
+    
+    // 计数并把已格式化的 payload 交给 sink_it_(log 与 log_limited 共用)
+    void log_payload_(level lvl, const fmt::memory_buffer& buf) {
+        auto& counters = counters_.local();
+        counters[static_cast<size_t>(lvl)].fetch_add(1, std::memory_order_relaxed);
+        counters[counter_bytes_].fetch_add(buf.size(), std::memory_order_relaxed);
+        
+        // 创建 log_msg
+        details::log_msg msg(
+            name_,
+            lvl,
+            string_view_t(buf.data(), buf.size())
+        );
+        
+        // 输出到所有 sink
+        sink_it_(msg);
+    }
 
     // 添加友元类声明
     friend class details::thread_pool;
@@ -122,6 +196,11 @@ protected:
     std::vector<sinks::sink_ptr> sinks_;       // Sink 列表
     level level_{level::trace};                 // 日志级别
     level flush_level_{level::off};             // 自动刷新级别
+    
+    // 计数:下标 0-6 为各级别消息数,之后是被过滤的调用数与格式化字节数
+    static constexpr size_t counter_filtered_ = 7;
+    static constexpr size_t counter_bytes_ = 8;
+    details::striped_counters<9> counters_;
 };
 
 } // namespace minispdlog
\ No newline at end of file
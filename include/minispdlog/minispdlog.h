@@ -4,10 +4,17 @@
 #include "level.h"
 #include "logger.h"
 #include "registry.h"
+#include "rate_limit.h"
 #include "sinks/console_sink.h"
 #include "sinks/color_console_sink.h"
 #include "sinks/file_sink.h"
 #include "sinks/rotating_file_sink.h"
+#include "sinks/time_rotating_file_sink.h"
+#include "sinks/mmap_file_sink.h"
+#include "sinks/uring_file_sink.h"
+#include "sinks/direct_file_sink.h"
+#include "sinks/fd_file_sink.h"
+#include "sinks/dup_filter_sink.h"
 #include <fmt/format.h>
 #include <memory>
 #include <string>
@@ -68,6 +75,16 @@ inline void flush_all() {
     registry::instance().flush_all();
 }
 
+// 每隔 interval 由后台线程刷新所有 logger(interval <= 0 时停止)
+inline void flush_every(std::chrono::milliseconds interval) {
+    registry::instance().flush_every(interval);
+}
+
+// 所有 logger 及其 sink 的计数快照(供指标导出)
+inline registry_stats stats() {
+    return registry::instance().stats();
+}
+
 // ============================================================================
 // 工厂函数:快速创建并注册 logger (多线程安全版本 _mt)
 // ============================================================================
@@ -121,13 +138,85 @@ inline std::shared_ptr<logger> rotating_logger_mt(
     const std::string& logger_name,
     const std::string& filename,
     size_t max_size,
-    size_t max_files
+    size_t max_files,
+    sinks::rotation_scheme scheme = sinks::rotation_scheme::rename_cascade
 ) {
-    auto sink = std::make_shared<sinks::rotating_file_sink_mt>(filename, max_size, max_files);
+    auto sink = std::make_shared<sinks::rotating_file_sink_mt>(filename, max_size, max_files, scheme);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+
+// 创建按时间滚动的文件 logger(多线程安全)
+// filename_pattern 支持日期占位符,如 "logs/app_%Y-%m-%d.log"
+inline std::shared_ptr<logger> time_rotating_logger_mt(
+    const std::string& logger_name,
+    const std::string& filename_pattern,
+    sinks::rotation_period period = sinks::rotation_period::daily,
+    size_t max_size = 0,
+    size_t max_files = 1
+) {
+    auto sink = std::make_shared<sinks::time_rotating_file_sink_mt>(filename_pattern, period, max_size, max_files);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+
+#ifndef MINISPDLOG_WINDOWS
+// 创建内存映射文件 logger(多线程安全,仅 POSIX)
+inline std::shared_ptr<logger> mmap_logger_mt(
+    const std::string& logger_name,
+    const std::string& filename,
+    bool truncate = false,
+    size_t chunk_size = 16 * 1024 * 1024,
+    sinks::msync_policy policy = sinks::msync_policy::never
+) {
+    auto sink = std::make_shared<sinks::mmap_file_sink_mt>(filename, truncate, chunk_size, policy);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+
+// 创建绕过页缓存(O_DIRECT)的文件 logger(多线程安全,仅 POSIX)
+inline std::shared_ptr<logger> direct_logger_mt(
+    const std::string& logger_name,
+    const std::string& filename,
+    bool truncate = false
+) {
+    auto sink = std::make_shared<sinks::direct_file_sink_mt>(filename, truncate);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+
+// 创建基于文件描述符的缓冲文件 logger(多线程安全,仅 POSIX)
+inline std::shared_ptr<logger> fd_logger_mt(
+    const std::string& logger_name,
+    const std::string& filename,
+    bool truncate = false,
+    size_t buffer_size = 1024 * 1024,
+    sinks::fd_flush_policy policy = sinks::fd_flush_policy::never()
+) {
+    auto sink = std::make_shared<sinks::fd_file_sink_mt>(filename, truncate, buffer_size, policy);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+#endif
+
+#ifdef MINISPDLOG_LINUX
+// 创建 io_uring 文件 logger(多线程安全,仅 Linux,不支持时自动回退到 pwrite)
+inline std::shared_ptr<logger> uring_logger_mt(
+    const std::string& logger_name,
+    const std::string& filename,
+    bool truncate = false
+) {
+    auto sink = std::make_shared<sinks::uring_file_sink_mt>(filename, truncate);
     auto new_logger = std::make_shared<logger>(logger_name, sink);
     register_logger(new_logger);
     return new_logger;
 }
+#endif
 
 // ============================================================================
 // 工厂函数:单线程版本 (_st) - 性能更高,但不支持多线程
@@ -182,46 +271,130 @@ inline std::shared_ptr<logger> rotating_logger_st(
     const std::string& logger_name,
     const std::string& filename,
     size_t max_size,
-    size_t max_files
+    size_t max_files,
+    sinks::rotation_scheme scheme = sinks::rotation_scheme::rename_cascade
 ) {
-    auto sink = std::make_shared<sinks::rotating_file_sink_st>(filename, max_size, max_files);
+    auto sink = std::make_shared<sinks::rotating_file_sink_st>(filename, max_size, max_files, scheme);
     auto new_logger = std::make_shared<logger>(logger_name, sink);
     register_logger(new_logger);
     return new_logger;
 }
 
+// 创建按时间滚动的文件 logger(单线程)
+// filename_pattern 支持日期占位符,如 "logs/app_%Y-%m-%d.log"
+inline std::shared_ptr<logger> time_rotating_logger_st(
+    const std::string& logger_name,
+    const std::string& filename_pattern,
+    sinks::rotation_period period = sinks::rotation_period::daily,
+    size_t max_size = 0,
+    size_t max_files = 1
+) {
+    auto sink = std::make_shared<sinks::time_rotating_file_sink_st>(filename_pattern, period, max_size, max_files);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+
+#ifndef MINISPDLOG_WINDOWS
+// 创建内存映射文件 logger(单线程,仅 POSIX)
+inline std::shared_ptr<logger> mmap_logger_st(
+    const std::string& logger_name,
+    const std::string& filename,
+    bool truncate = false,
+    size_t chunk_size = 16 * 1024 * 1024,
+    sinks::msync_policy policy = sinks::msync_policy::never
+) {
+    auto sink = std::make_shared<sinks::mmap_file_sink_st>(filename, truncate, chunk_size, policy);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+
+// 创建绕过页缓存(O_DIRECT)的文件 logger(单线程,仅 POSIX)
+inline std::shared_ptr<logger> direct_logger_st(
+    const std::string& logger_name,
+    const std::string& filename,
+    bool truncate = false
+) {
+    auto sink = std::make_shared<sinks::direct_file_sink_st>(filename, truncate);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+
+// 创建基于文件描述符的缓冲文件 logger(单线程,仅 POSIX)
+inline std::shared_ptr<logger> fd_logger_st(
+    const std::string& logger_name,
+    const std::string& filename,
+    bool truncate = false,
+    size_t buffer_size = 1024 * 1024,
+    sinks::fd_flush_policy policy = sinks::fd_flush_policy::never()
+) {
+    auto sink = std::make_shared<sinks::fd_file_sink_st>(filename, truncate, buffer_size, policy);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+#endif
+
+#ifdef MINISPDLOG_LINUX
+// 创建 io_uring 文件 logger(单线程,仅 Linux,不支持时自动回退到 pwrite)
+inline std::shared_ptr<logger> uring_logger_st(
+    const std::string& logger_name,
+    const std::string& filename,
+    bool truncate = false
+) {
+    auto sink = std::make_shared<sinks::uring_file_sink_st>(filename, truncate);
+    auto new_logger = std::make_shared<logger>(logger_name, sink);
+    register_logger(new_logger);
+    return new_logger;
+}
+#endif
+
 // ============================================================================
-// 全局日志接口:直接使用默认 logger
+// 全局日志接口:直接使用默认 logger(默认 logger 被 drop 后静默忽略)
 // ============================================================================
 
 template<typename... Args>
 inline void trace(fmt::format_string<Args...> fmt, Args&&... args) {
-    default_logger()->trace(fmt, std::forward<Args>(args)...);
+    if (auto l = default_logger()) {
+        l->trace(fmt, std::forward<Args>(args)...);
+    }
 }
 
 template<typename... Args>
 inline void debug(fmt::format_string<Args...> fmt, Args&&... args) {
-    default_logger()->debug(fmt, std::forward<Args>(args)...);
+    if (auto l = default_logger()) {
+        l->debug(fmt, std::forward<Args>(args)...);
+    }
 }
 
 template<typename... Args>
 inline void info(fmt::format_string<Args...> fmt, Args&&... args) {
-    default_logger()->info(fmt, std::forward<Args>(args)...);
+    if (auto l = default_logger()) {
+        l->info(fmt, std::forward<Args>(args)...);
+    }
 }
 
 template<typename... Args>
 inline void warn(fmt::format_string<Args...> fmt, Args&&... args) {
-    default_logger()->warn(fmt, std::forward<Args>(args)...);
+    if (auto l = default_logger()) {
+        l->warn(fmt, std::forward<Args>(args)...);
+    }
 }
 
 template<typename... Args>
 inline void error(fmt::format_string<Args...> fmt, Args&&... args) {
-    default_logger()->error(fmt, std::forward<Args>(args)...);
+    if (auto l = default_logger()) {
+        l->error(fmt, std::forward<Args>(args)...);
+    }
 }
 
 template<typename... Args>
 inline void critical(fmt::format_string<Args...> fmt, Args&&... args) {
-    default_logger()->critical(fmt, std::forward<Args>(args)...);
+    if (auto l = default_logger()) {
+        l->critical(fmt, std::forward<Args>(args)...);
+    }
 }
 
 } // namespace minispdlog
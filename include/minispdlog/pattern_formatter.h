@@ -12,12 +12,14 @@ namespace minispdlog {
 
 // pattern_formatter:基于 pattern 字符串的格式化器
 // 支持类似 strftime 的占位符语法
+// format() 可被多个线程同时调用(时间缓存是 thread_local 的);set_pattern() 不可与 format() 并发
 class pattern_formatter : public formatter {
 public:
     // 构造函数:接受 pattern 字符串
     // pattern 示例: "[%Y-%m-%d %H:%M:%S] [%l] [%n] %v"
+    // %^ 和 %$ 标出彩色控制台 sink 的着色范围,本身不输出内容
     explicit pattern_formatter(
-        std::string pattern = "[%Y-%m-%d %H:%M:%S] [%l] %v"
+        std::string pattern = "[%Y-%m-%d %H:%M:%S] [%^%l%$] %v"
     );
     
     ~pattern_formatter() override = default;
@@ -25,6 +27,10 @@ public:
     // 实现 formatter 接口
     void format(const details::log_msg& msg, fmt::memory_buffer& dest) override;
     std::unique_ptr<formatter> clone() const override;
+    bool thread_safe() const override;
+    
+    // pattern 相同即等价(时间统一按本地时间格式化)
+    bool equivalent(const formatter& other) const override;
     
     // 设置新的 pattern(重新编译)
     void set_pattern(std::string pattern);
@@ -44,15 +50,11 @@ private:
     // 编译 pattern 字符串为 flag_formatter 向量
     void compile_pattern();
     
-    // 获取格式化后的时间结构
-    std::tm get_time(const details::log_msg& msg);
+    // 获取格式化后的时间结构(每个线程缓存最近一秒的结果)
+    static const std::tm& get_time(const details::log_msg& msg);
     
     std::string pattern_;                               // pattern 字符串
     std::vector<std::unique_ptr<flag_formatter>> formatters_;  // flag_formatter 向量
-    
-    // 性能优化:时间缓存
-    std::chrono::seconds last_log_secs_{0};            // 上次日志的秒数
-    std::tm cached_tm_{};                               // 缓存的 tm 结构
 };
 
 } // namespace minispdlog
\ No newline at end of file
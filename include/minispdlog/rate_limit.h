@@ -0,0 +1,257 @@
+#pragma once
+
+#include "common.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+// rate_limit.h:调用点限流与采样
+//
+// 热循环里的一条 warn 可能每分钟产生上百万条相同的日志并塞满异步队列。
+// 下面的宏给每个调用点一份 static 状态,在级别过滤之后、格式化之前用 relaxed 原子操作决定是否放行:
+//
+//   MINISPDLOG_LOG_EVERY_N(logger, lvl, n, fmt, args...)       第 1、n+1、2n+1... 次调用放行
+//   MINISPDLOG_LOG_FIRST_N(logger, lvl, n, fmt, args...)       只放行前 n 次
+//   MINISPDLOG_LOG_EVERY(logger, lvl, period, fmt, args...)    令牌桶:平均每 period 放行一次
+//   MINISPDLOG_LOG_SAMPLED(logger, lvl, key, rate, fmt, args...)
+//       按 key(如 trace id)的哈希放行约 rate 比例;同一个 key 在任何进程、任何调用点的结论相同
+//
+// 放行的记录末尾附加 " (N suppressed)",N 为该调用点上次放行以来被抑制的次数
+// (LOG_FIRST_N 达到上限后不再放行,不统计抑制次数)
+//
+// 每个限流器提供 allow(suppressed) 与 restore(suppressed):放行后格式化抛出异常时,
+// logger::log_limited 用 restore 归还抑制计数,由下一条放行的记录报告;
+// first_n 与令牌桶同时归还放行名额,every_n 的名额由调用次数决定,无法归还
+//
+// 注意:
+//   - 状态属于调用点(宏展开处的 static 局部变量),与 logger 无关;n/period/rate 以第一次执行时的值为准
+//   - 低于 logger 级别的调用不消耗配额
+//   - logger 可以是指针或 shared_ptr
+
+namespace minispdlog {
+namespace details {
+
+// every_n_limiter: 第 1、n+1、2n+1... 次调用放行,每次调用一次 fetch_add
+class every_n_limiter {
+public:
+    explicit every_n_limiter(uint64_t n)
+        : n_(n == 0 ? 1 : n)
+    {}
+
+    bool allow(uint64_t& suppressed) {
+        uint64_t call = calls_.fetch_add(1, std::memory_order_relaxed);
+        if (call % n_ != 0) {
+            return false;
+        }
+        // 相邻两次放行之间恰好有 n - 1 次调用,再加上格式化失败时归还的计数
+        suppressed = call == 0 ? 0 : n_ - 1;
+        if (carried_.load(std::memory_order_relaxed) != 0) {
+            suppressed += carried_.exchange(0, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void restore(uint64_t suppressed) {
+        if (suppressed != 0) {
+            carried_.fetch_add(suppressed, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    const uint64_t n_;
+    std::atomic<uint64_t> calls_{0};
+    std::atomic<uint64_t> carried_{0};
+};
+
+// first_n_limiter: 只放行前 n 次;之后每次调用只有一次 relaxed 读
+class first_n_limiter {
+public:
+    explicit first_n_limiter(uint64_t n)
+        : n_(n)
+    {}
+
+    bool allow(uint64_t& suppressed) {
+        suppressed = 0;
+        if (calls_.load(std::memory_order_relaxed) >= n_) {
+            return false;
+        }
+        return calls_.fetch_add(1, std::memory_order_relaxed) < n_;
+    }
+
+    // 归还放行名额(first_n 不统计抑制次数)
+    void restore(uint64_t) {
+        calls_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    const uint64_t n_;
+    std::atomic<uint64_t> calls_{0};
+};
+
+// token_bucket_limiter: 令牌桶,平均每 period 补充一个令牌,最多积攒 burst 个
+//
+// 用 GCRA(理论到达时间)表示令牌桶,状态只有一个原子时间戳:
+//   - tat 是令牌桶"刚好补满"的时刻;now 之后还能容纳的突发为 (now + burst * period - tat) / period
+//   - 放行时把 tat 推后一个 period(CAS),拒绝时只读不写
+class token_bucket_limiter {
+public:
+    explicit token_bucket_limiter(std::chrono::nanoseconds period, uint64_t burst = 1)
+        : period_ns_(period.count() > 0 ? period.count() : 1)
+        , burst_ns_(period_ns_ * static_cast<int64_t>(burst == 0 ? 1 : burst))
+    {}
+
+    bool allow(uint64_t& suppressed) {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t tat = tat_.load(std::memory_order_relaxed);
+        for (;;) {
+            int64_t base = tat > now ? tat : now;
+            int64_t next = base + period_ns_;
+            if (next - now > burst_ns_) {
+                suppressed_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (tat_.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        suppressed = take_suppressed_();
+        return true;
+    }
+
+    // 归还令牌(tat 退回一个 period)与抑制计数
+    void restore(uint64_t suppressed) {
+        tat_.fetch_sub(period_ns_, std::memory_order_relaxed);
+        if (suppressed != 0) {
+            suppressed_.fetch_add(suppressed, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    uint64_t take_suppressed_() {
+        if (suppressed_.load(std::memory_order_relaxed) == 0) {
+            return 0;
+        }
+        return suppressed_.exchange(0, std::memory_order_relaxed);
+    }
+
+    const int64_t period_ns_;
+    const int64_t burst_ns_;
+    std::atomic<int64_t> tat_{0};
+    std::atomic<uint64_t> suppressed_{0};
+};
+
+// 采样用的稳定哈希:结果只取决于 key 本身(不依赖 std::hash 的实现),跨进程一致
+inline uint64_t sample_hash(uint64_t key) {
+    // splitmix64 终结函数
+    key += 0x9e3779b97f4a7c15ULL;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+inline uint64_t sample_hash(std::string_view key) {
+    // FNV-1a,再经 splitmix64 打散低位
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return sample_hash(h);
+}
+
+// key_sampler: 按 key 的哈希放行约 rate 比例的调用(rate 取 0-1)
+class key_sampler {
+public:
+    explicit key_sampler(double rate)
+        : threshold_(threshold_of_(rate))
+    {}
+
+    // 绑定一次调用的 key,交给 logger::log_limited
+    class decision {
+    public:
+        decision(key_sampler& sampler, uint64_t hash)
+            : sampler_(sampler)
+            , hash_(hash)
+        {}
+
+        bool allow(uint64_t& suppressed) {
+            return sampler_.allow_hash_(hash_, suppressed);
+        }
+
+        // 采样结论只取决于 key,没有名额可归还
+        void restore(uint64_t suppressed) {
+            if (suppressed != 0) {
+                sampler_.suppressed_.fetch_add(suppressed, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        key_sampler& sampler_;
+        uint64_t hash_;
+    };
+
+    decision for_key(std::string_view key) {
+        return decision(*this, sample_hash(key));
+    }
+
+    template<typename Int, typename = std::enable_if_t<std::is_integral<Int>::value>>
+    decision for_key(Int key) {
+        return decision(*this, sample_hash(static_cast<uint64_t>(key)));
+    }
+
+private:
+    // 比较哈希的高 53 位,避免 rate 接近 1 时 double -> uint64 溢出
+    static uint64_t threshold_of_(double rate) {
+        if (!(rate > 0.0)) {
+            return 0;
+        }
+        if (rate >= 1.0) {
+            return uint64_t(1) << 53;
+        }
+        return static_cast<uint64_t>(rate * static_cast<double>(uint64_t(1) << 53));
+    }
+
+    bool allow_hash_(uint64_t hash, uint64_t& suppressed) {
+        if ((hash >> 11) >= threshold_) {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = suppressed_.load(std::memory_order_relaxed) == 0
+            ? 0 : suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    const uint64_t threshold_;
+    std::atomic<uint64_t> suppressed_{0};
+};
+
+} // namespace details
+} // namespace minispdlog
+
+#define MINISPDLOG_LOG_EVERY_N(logger, lvl, n, ...)                                      \
+    do {                                                                                 \
+        static ::minispdlog::details::every_n_limiter minispdlog_site_(n);               \
+        (logger)->log_limited(minispdlog_site_, lvl, __VA_ARGS__);                       \
+    } while (0)
+
+#define MINISPDLOG_LOG_FIRST_N(logger, lvl, n, ...)                                      \
+    do {                                                                                 \
+        static ::minispdlog::details::first_n_limiter minispdlog_site_(n);               \
+        (logger)->log_limited(minispdlog_site_, lvl, __VA_ARGS__);                       \
+    } while (0)
+
+#define MINISPDLOG_LOG_EVERY(logger, lvl, period, ...)                                   \
+    do {                                                                                 \
+        static ::minispdlog::details::token_bucket_limiter minispdlog_site_(period);     \
+        (logger)->log_limited(minispdlog_site_, lvl, __VA_ARGS__);                       \
+    } while (0)
+
+#define MINISPDLOG_LOG_SAMPLED(logger, lvl, key, rate, ...)                              \
+    do {                                                                                 \
+        static ::minispdlog::details::key_sampler minispdlog_site_(rate);                \
+        (logger)->log_limited(minispdlog_site_.for_key(key), lvl, __VA_ARGS__);          \
+    } while (0)
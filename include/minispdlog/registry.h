@@ -6,14 +6,30 @@
 #include <memory>
 #include <unordered_map>
 #include <mutex>
+#include <chrono>
+#include <array>
+#include <vector>
 
 namespace minispdlog {
 
 // 前向声明
 namespace details {
 class thread_pool;
+class periodic_worker;
+struct thread_pool_options;
 }
 
+// registry_stats: registry::stats() 返回的快照,供指标导出使用
+struct registry_stats {
+    std::vector<logger_stats> loggers;          // 每个已注册的 logger(以及未注册的默认 logger)
+    std::vector<sinks::sink_stats> sinks;       // 所有 sink,多个 logger 共用的只出现一次
+    
+    // 所有 logger 的汇总
+    std::array<uint64_t, 7> messages{};         // 按级别通过过滤的消息数
+    uint64_t filtered = 0;                      // 低于级别被丢弃的调用数
+    uint64_t bytes = 0;                         // 格式化出的 payload 字节数
+};
+
 // registry: Logger 注册表(单例模式)
 // 参考 spdlog 设计:全局管理所有 logger + 全局线程池
 //
@@ -59,6 +75,15 @@ public:
     // 刷新所有 logger
     void flush_all();
     
+    // 汇总所有 logger 及其 sink 的计数(只在取 logger 列表时持锁)
+    registry_stats stats();
+    
+    // 由一个后台线程每隔 interval 刷新所有 logger(interval <= 0 时停止)
+    // 同步 logger 直接在后台线程 flush(),因此只刷新 sink 全部线程安全(_mt)的 logger,
+    // 含 _st sink 的同步 logger 被跳过;异步 logger 按线程池合并成一条刷新请求,
+    // 由工作线程执行,上一条尚未处理时不再重复入队
+    void flush_every(std::chrono::milliseconds interval);
+    
     // ========== 线程池管理(第8天新增) ==========
     
     // 初始化全局线程池
@@ -67,6 +92,9 @@ public:
     // 注意:必须在创建异步 logger 之前调用
     void init_thread_pool(size_t queue_size, size_t threads_n = 1);
     
+    // 按配置初始化全局线程池(可选分片模式,见 details::thread_pool_options)
+    void init_thread_pool(const details::thread_pool_options& options);
+    
     // 获取全局线程池(如果不存在则自动创建默认配置的线程池)
     std::shared_ptr<details::thread_pool> thread_pool();
     
@@ -75,7 +103,7 @@ public:
     
 private:
     registry();
-    ~registry() = default;
+    ~registry();
     
     // 检查名称是否已存在(抛出异常)
     void throw_if_exists_(const std::string& logger_name);
@@ -83,12 +111,22 @@ private:
     // 创建默认线程池(延迟初始化)
     void create_default_thread_pool_();
     
+    // 周期刷新的一次执行(在 periodic_worker 线程中调用)
+    void periodic_flush_();
+    
+    // 在锁内复制当前所有 logger(含未注册的默认 logger)
+    std::vector<std::shared_ptr<logger>> loggers_snapshot_();
+    
     std::mutex mutex_;                                              // 保护下面的成员
     std::unordered_map<std::string, std::shared_ptr<logger>> loggers_;  // Logger 映射表
     std::shared_ptr<logger> default_logger_;                        // 默认 logger
     
     // 第8天新增:全局线程池
     std::shared_ptr<details::thread_pool> thread_pool_;            // 全局线程池
+    
+    // 周期刷新线程(最后声明,最先析构,保证回调运行时其他成员仍有效)
+    std::mutex flusher_mutex_;                                      // 保护 periodic_flusher_
+    std::unique_ptr<details::periodic_worker> periodic_flusher_;
 };
 
 } // namespace minispdlog
\ No newline at end of file
@@ -4,12 +4,30 @@
 #include "../details/log_msg.h"
 #include "../formatter.h"
 #include "../pattern_formatter.h"
+#include "../details/combining_mutex.h"
+#include "../details/histogram.h"
+#include "../details/latency.h"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace minispdlog {
 namespace sinks {
 
+// sink_stats: sink 的计数快照(见 sink::stats)
+struct sink_stats {
+    const void* id = nullptr;                   // sink 地址,同一 sink 挂在多个 logger 上时用于去重
+    uint64_t records = 0;                       // 写入的记录数
+    uint64_t bytes = 0;                         // 写入的字节数(格式化后;未格式化的记录按 payload 计)
+    details::histogram_snapshot write_ns;       // 锁内写入耗时(纳秒);只统计开启 set_write_timing 后的记录和被采样的记录
+    details::histogram_snapshot flush_ns;       // 每次 flush()/sync() 的耗时(纳秒)
+};
+
 // Sink 接口类(纯虚)
 class sink {
 public:
@@ -21,6 +39,18 @@ public:
     // 刷新缓冲区
     virtual void flush() = 0;
     
+    // log()/flush() 是否允许多个线程同时调用
+    // 直接实现本接口的 sink 按约定必须线程安全;null_mutex 版本的 base_sink 返回 false
+    virtual bool thread_safe() const {
+        return true;
+    }
+    
+    // 持久化刷新:返回时数据已交给存储设备(文件 sink 会 fdatasync)
+    // 默认等同于 flush(),没有持久化概念的 sink(如控制台)无需实现
+    virtual void sync() {
+        flush();
+    }
+    
     // 设置日志级别
     virtual void set_level(level log_level) = 0;
     virtual level get_level() const = 0;
@@ -30,28 +60,127 @@ public:
     
     // Formatter 相关接口
     virtual void set_formatter(std::unique_ptr<formatter> sink_formatter) = 0;
+    
+    // 可与其他 sink 共用格式化结果时返回当前 formatter,否则返回空指针
+    // 返回的 formatter 允许在 sink 的锁之外调用;持有期间即使 set_formatter() 替换也不会被释放
+    virtual std::shared_ptr<formatter> shared_formatter() const {
+        return nullptr;
+    }
+    
+    // 写入已格式化好的记录(线程安全)
+    // formatted 必须由与 shared_formatter() 等价的 formatter 对 msg 格式化得到
+    virtual void log_formatted(const details::log_msg& msg, std::string_view formatted) {
+        (void)formatted;
+        log(msg);
+    }
+    
+    // 计数快照;base_sink 会统计,直接实现本接口的 sink 默认只返回 id
+    virtual sink_stats stats() const {
+        sink_stats st;
+        st.id = this;
+        return st;
+    }
+};
+
+// null_mutex:用于单线程版本
+struct null_mutex {
+    void lock() {}
+    void unlock() {}
 };
 
 // base_sink:实现了线程安全的 Sink 基类
+//
+// 子类实现 sink_it_(锁内格式化并写入);需要锁外格式化的 sink 改为继承 formatted_sink
+//
+// 锁外格式化(多线程版本,见 formatted_sink):
+//   - log() 先在调用线程的 thread_local 缓冲区里格式化,锁内只做追加/写入
+//   - 只有 formatter::thread_safe() 为 true 时才这样做,否则仍在锁内调用 sink_it_
+//   - null_mutex 版本没有锁可缩短,始终走 sink_it_
+//
+// 计数(stats()):
+//   - 记录数/字节数在锁内更新,同一时刻只有一个写者,不需要原子读-改-写
+//   - 写入耗时默认不统计(每条记录两次读时钟);set_write_timing(true) 开启,
+//     被延迟采样的记录(msg.trace)总是计时。计时只包含锁内部分,直方图在释放锁之后更新
 template<typename Mutex>
 class base_sink : public sink {
 public:
-    base_sink() 
-        : level_(level::trace)
-        , formatter_(std::make_unique<pattern_formatter>())  // 默认 formatter
+    base_sink()
+        : base_sink(false)
     {}
     
     base_sink(const base_sink&) = delete;
     base_sink& operator=(const base_sink&) = delete;
     
     void log(const details::log_msg& msg) override {
-        std::lock_guard<Mutex> lock(mutex_);
-        sink_it_(msg); // 调用的是子类的sink_it_方法
+        if constexpr (!std::is_same<Mutex, null_mutex>::value) {
+            if (format_outside_lock_) {
+                // 持有引用:格式化期间 set_formatter() 替换掉的旧 formatter 不会被释放
+                std::shared_ptr<formatter> f = std::atomic_load_explicit(&formatter_, std::memory_order_acquire);
+                if (f->thread_safe()) {
+                    fmt::memory_buffer& buf = thread_buffer_();
+                    buf.clear();
+                    f->format(msg, buf);
+                    write_locked_(msg, std::string_view(buf.data(), buf.size()));
+                    return;
+                }
+            }
+        }
+        write_locked_(msg, std::string_view());
+    }
+    
+    void log_formatted(const details::log_msg& msg, std::string_view formatted) override {
+        write_locked_(msg, formatted);
+    }
+    
+    // null_mutex 版本不加锁;自行同步的子类可以重写为 true
+    bool thread_safe() const override {
+        return !std::is_same<Mutex, null_mutex>::value;
+    }
+    
+    // 是否统计每条记录的锁内写入耗时(stats().write_ns),默认关闭
+    void set_write_timing(bool enabled) {
+        write_timing_.store(enabled, std::memory_order_relaxed);
+    }
+    
+    bool write_timing() const {
+        return write_timing_.load(std::memory_order_relaxed);
+    }
+    
+    std::shared_ptr<formatter> shared_formatter() const override {
+        if (!format_outside_lock_) {
+            return nullptr;
+        }
+        std::shared_ptr<formatter> f = std::atomic_load_explicit(&formatter_, std::memory_order_acquire);
+        if constexpr (!std::is_same<Mutex, null_mutex>::value) {
+            if (!f->thread_safe()) {
+                return nullptr;
+            }
+        }
+        return f;
     }
     
     void flush() override {
         std::lock_guard<Mutex> lock(mutex_);
+        auto start = std::chrono::steady_clock::now();
         flush_();
+        flush_ns_.record(elapsed_ns_(start));
+    }
+    
+    void sync() override {
+        std::lock_guard<Mutex> lock(mutex_);
+        auto start = std::chrono::steady_clock::now();
+        sync_();
+        flush_ns_.record(elapsed_ns_(start));
+    }
+    
+    sink_stats stats() const override {
+        sink_stats st;
+        st.id = this;
+        st.records = records_.load(std::memory_order_relaxed);
+        st.bytes = bytes_.load(std::memory_order_relaxed);
+        st.write_ns = write_ns_.snapshot();
+        st.flush_ns = flush_ns_.snapshot();
+        return st;
     }
     
     void set_level(level log_level) override {
@@ -68,30 +197,156 @@ public:
         return msg_level >= level_;
     }
     
+    // 其他线程可能正在锁外使用旧的 formatter:它们各自持有 shared_ptr,
+    // 旧实例在最后一个使用者格式化完成后释放
     void set_formatter(std::unique_ptr<formatter> sink_formatter) override {
+        std::shared_ptr<formatter> f(std::move(sink_formatter));
         std::lock_guard<Mutex> lock(mutex_);
-        formatter_ = std::move(sink_formatter);
+        std::atomic_store_explicit(&formatter_, std::move(f), std::memory_order_release);
     }
     
 protected:
+    // format_outside_lock 只由 formatted_sink 置为 true
+    explicit base_sink(bool format_outside_lock)
+        : level_(level::trace)
+        , format_outside_lock_(format_outside_lock)
+        , formatter_(std::make_shared<pattern_formatter>())  // 默认 formatter
+    {}
+    
     // 子类需要实现的核心方法
     virtual void sink_it_(const details::log_msg& msg) = 0;
     virtual void flush_() = 0;
     
-    // 格式化日志消息
+    // 写入已格式化好的记录(持有锁时调用);formatted 以换行符结尾
+    // 只有 formatted_sink 会收到已格式化的记录;这里的默认实现忽略 formatted,照常交给 sink_it_
+    virtual void sink_formatted_(const details::log_msg& msg, std::string_view formatted) {
+        (void)formatted;
+        sink_it_(msg);
+    }
+    
+    // 持久化刷新,默认只做 flush_();文件 sink 重写为 flush_() + fdatasync
+    virtual void sync_() {
+        flush_();
+    }
+    
+    // 格式化日志消息(持有锁时调用:set_formatter() 也要持锁,formatter_ 不会被并发替换)
     void format_message(const details::log_msg& msg, fmt::memory_buffer& dest) {
         formatter_->format(msg, dest);
     }
     
     mutable Mutex mutex_;
     level level_;
-    std::unique_ptr<formatter> formatter_;  // 每个 sink 拥有自己的 formatter
+    
+private:
+    const bool format_outside_lock_;        // formatted_sink 置为 true
+    
+    // 加锁写入一条记录;formatted 为空视图(data() == nullptr)表示尚未格式化
+    void write_locked_(const details::log_msg& msg, std::string_view formatted) {
+        bool timed = write_timing_.load(std::memory_order_relaxed);
+        if constexpr (std::is_same<Mutex, details::combining_mutex>::value) {
+            // flat combining:竞争时由持锁线程代为写入(见 details::combining_mutex)
+            // 本线程作为 combiner 时可能代写多条,耗时先记在栈上,combine() 返回(已释放锁)后再记入直方图
+            std::array<uint64_t, details::combining_mutex::max_slots + 1> elapsed;
+            size_t timed_n = 0;
+            mutex_.combine(msg, formatted, [this, timed, &elapsed, &timed_n](const details::log_msg& m, std::string_view f) {
+                uint64_t ns = write_record_(m, f, timed);
+                if (ns != no_timing_ && timed_n < elapsed.size()) {
+                    elapsed[timed_n++] = ns;
+                }
+            });
+            for (size_t i = 0; i < timed_n; ++i) {
+                write_ns_.record(elapsed[i]);
+            }
+        } else {
+            uint64_t ns;
+            {
+                std::lock_guard<Mutex> lock(mutex_);
+                ns = write_record_(msg, formatted, timed);
+            }
+            if (ns != no_timing_) {
+                write_ns_.record(ns);
+            }
+        }
+    }
+    
+    // 持有锁时调用;计时(timed 或被采样的记录)时返回锁内写入耗时,否则返回 no_timing_
+    uint64_t write_record_(const details::log_msg& msg, std::string_view formatted, bool timed) {
+        timed = timed || msg.trace;
+        std::chrono::steady_clock::time_point start;
+        if (timed) {
+            start = std::chrono::steady_clock::now();
+        }
+        size_t bytes;
+        if (formatted.data()) {
+            sink_formatted_(msg, formatted);
+            bytes = formatted.size();
+        } else {
+            sink_it_(msg); // 调用的是子类的sink_it_方法
+            bytes = msg.payload.size();
+        }
+        
+        // 持有锁,只有一个写者
+        records_.store(records_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        bytes_.store(bytes_.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+        
+        if (!timed) {
+            return no_timing_;
+        }
+        auto end = std::chrono::steady_clock::now();
+        
+        // 被采样的记录:第一个 sink 的开始时刻记为格式化完成,最后一个 sink 的结束时刻记为写入完成
+        if (msg.trace) {
+            if (msg.trace->formatted == 0) {
+                msg.trace->formatted = details::steady_ns(start);
+            }
+            msg.trace->written = details::steady_ns(end);
+        }
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    
+    static constexpr uint64_t no_timing_ = ~uint64_t(0);
+    
+    static uint64_t elapsed_ns_(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+    
+    // 每个线程一块格式化缓冲区,容量在多次调用间复用
+    static fmt::memory_buffer& thread_buffer_() {
+        static thread_local fmt::memory_buffer buf;
+        return buf;
+    }
+    
+    // 当前 formatter:锁外用 std::atomic_load 读取,set_formatter() 在锁内 std::atomic_store
+    std::shared_ptr<formatter> formatter_;
+    
+    std::atomic<bool> write_timing_{false};                 // 是否统计每条记录的写入耗时
+    
+    // 计数(只在持有锁时写;write_ns_ 在释放锁之后更新)
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> bytes_{0};
+    details::log_histogram write_ns_;
+    details::log_histogram flush_ns_;
 };
 
-// null_mutex:用于单线程版本
-struct null_mutex {
-    void lock() {}
-    void unlock() {}
+// formatted_sink:锁外格式化的 sink 基类
+// 子类只实现 sink_formatted_(锁内写入已格式化的记录),不再实现 sink_it_:
+//   - 多线程版本在调用线程格式化,锁内只调用 sink_formatted_
+//   - 单线程版本(或 formatter 不是线程安全的)在锁内格式化后调用 sink_formatted_
+template<typename Mutex>
+class formatted_sink : public base_sink<Mutex> {
+protected:
+    formatted_sink()
+        : base_sink<Mutex>(true)
+    {}
+    
+    void sink_it_(const details::log_msg& msg) override {
+        fmt::memory_buffer formatted;
+        this->format_message(msg, formatted);
+        sink_formatted_(msg, std::string_view(formatted.data(), formatted.size()));
+    }
+    
+    void sink_formatted_(const details::log_msg& msg, std::string_view formatted) override = 0;
 };
 
 using sink_ptr = std::shared_ptr<sink>;
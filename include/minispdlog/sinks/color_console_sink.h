@@ -1,9 +1,10 @@
 #pragma once
 
 #include "base_sink.h"
-#include <iostream>
+#include "../details/console_output.h"
 #include <mutex>
 #include <array>
+#include <string_view>
 
 namespace minispdlog {
 namespace sinks {
@@ -11,54 +12,111 @@ namespace sinks {
 // ANSI 颜色码
 // 参考: https://en.wikipedia.org/wiki/ANSI_escape_code
 namespace color {
-    constexpr const char* reset   = "\033[0m";
-    constexpr const char* bold    = "\033[1m";
-    constexpr const char* white   = "\033[37m";
-    constexpr const char* green   = "\033[32m";
-    constexpr const char* yellow  = "\033[33m";
-    constexpr const char* red     = "\033[31m";
-    constexpr const char* magenta = "\033[35m";
-    constexpr const char* cyan    = "\033[36m";
+    constexpr std::string_view reset       = "\033[0m";
+    constexpr std::string_view bold        = "\033[1m";
+    constexpr std::string_view white       = "\033[37m";
+    constexpr std::string_view green       = "\033[32m";
+    constexpr std::string_view yellow      = "\033[33m";
+    constexpr std::string_view red         = "\033[31m";
+    constexpr std::string_view magenta     = "\033[35m";
+    constexpr std::string_view cyan        = "\033[36m";
+    constexpr std::string_view bold_red    = "\033[1m\033[31m";
 }
 
+// 何时输出颜色
+enum class color_mode {
+    automatic,  // 输出是终端时才着色(默认)
+    always,     // 总是着色
+    never       // 从不着色
+};
+
 // color_console_sink:带颜色支持的控制台 Sink
 // 使用 ANSI 转义码为不同级别的日志添加颜色
-// 在不支持颜色的终端上也能正常工作(只是会显示转义码)
+//
+// 着色范围:
+//   - pattern 中用 %^ ... %$ 标出的部分(如 "[%^%l%$] %v" 只给级别着色)
+//   - pattern 中没有 %^/%$ 时整行着色
+//
+// 性能:
+//   - 颜色前缀是 string_view 常量,拼接进一个缓冲区后只做一次 write(fd)
+//   - 输出不是终端(被重定向/容器采集)时自动关闭颜色,输出与 console_sink 相同
 template<typename ConsoleMutex>
-class color_console_sink : public base_sink<ConsoleMutex> {
+class color_console_sink : public formatted_sink<ConsoleMutex> {
 public:
-    color_console_sink() {
-        // 初始化颜色映射
+    explicit color_console_sink(color_mode mode = color_mode::automatic)
+        : color_console_sink(details::stdout_fd, mode)
+    {}
+    
+    ~color_console_sink() override = default;
+    
+    // 修改颜色模式
+    void set_color_mode(color_mode mode) {
+        std::lock_guard<ConsoleMutex> lock(this->mutex_);
+        should_color_ = mode == color_mode::always ||
+                        (mode == color_mode::automatic && details::console_is_tty(fd_));
+    }
+    
+    // 当前是否输出颜色
+    bool should_color() const {
+        std::lock_guard<ConsoleMutex> lock(this->mutex_);
+        return should_color_;
+    }
+    
+protected:
+    // 供 color_stderr_sink 指定输出的文件描述符
+    color_console_sink(int fd, color_mode mode)
+        : fd_(fd)
+    {
         colors_[static_cast<int>(level::trace)] = color::white;
         colors_[static_cast<int>(level::debug)] = color::cyan;
         colors_[static_cast<int>(level::info)] = color::green;
         colors_[static_cast<int>(level::warn)] = color::yellow;
         colors_[static_cast<int>(level::error)] = color::red;
-        colors_[static_cast<int>(level::critical)] = std::string(color::bold) + color::red;
+        colors_[static_cast<int>(level::critical)] = color::bold_red;
+        
+        should_color_ = mode == color_mode::always ||
+                        (mode == color_mode::automatic && details::console_is_tty(fd_));
     }
     
-    ~color_console_sink() override = default;
-    
-protected:
-    void sink_it_(const details::log_msg& msg) override {
-        fmt::memory_buffer formatted;
-        this->format_message(msg, formatted);
+    void sink_formatted_(const details::log_msg& msg, std::string_view formatted) override {
+        if (!should_color_) {
+            details::console_write(fd_, formatted.data(), formatted.size());
+            return;
+        }
         
-        // 添加颜色前缀
-        const std::string& prefix = colors_[static_cast<int>(msg.lvl)];
+        // 没有 %^/%$ 时整行着色(换行符留在颜色之外)
+        size_t start = msg.color_range_start;
+        size_t end = msg.color_range_end;
+        if (end <= start) {
+            start = 0;
+            end = formatted.size();
+            if (end > 0 && formatted.data()[end - 1] == '\n') {
+                --end;
+            }
+        }
         
-        // 输出: 颜色前缀 + 消息 + 颜色重置
-        std::cout << prefix;
-        std::cout.write(formatted.data(), formatted.size());
-        std::cout << color::reset;
+        // 输出: 范围前 + 颜色 + 范围内 + 重置 + 范围后,拼成一次 write
+        std::string_view prefix = colors_[static_cast<int>(msg.lvl)];
+        const char* data = formatted.data();
+        fmt::memory_buffer out;
+        out.reserve(formatted.size() + prefix.size() + color::reset.size());
+        out.append(data, data + start);
+        out.append(prefix.data(), prefix.data() + prefix.size());
+        out.append(data + start, data + end);
+        out.append(color::reset.data(), color::reset.data() + color::reset.size());
+        out.append(data + end, data + formatted.size());
+        
+        details::console_write(fd_, out.data(), out.size());
     }
     
     void flush_() override {
-        std::cout << std::flush;
+        // 直接写 fd,没有用户态缓冲区
     }
     
 private:
-    std::array<std::string, 7> colors_;  // 7 个级别的颜色
+    int fd_;
+    bool should_color_{false};
+    std::array<std::string_view, 7> colors_{};  // 7 个级别的颜色
 };
 
 using color_console_sink_mt = color_console_sink<std::mutex>;
@@ -66,41 +124,17 @@ using color_console_sink_st = color_console_sink<null_mutex>;
 
 // stderr 彩色版本
 template<typename ConsoleMutex>
-class color_stderr_sink : public base_sink<ConsoleMutex> {
+class color_stderr_sink : public color_console_sink<ConsoleMutex> {
 public:
-    color_stderr_sink() {
-        colors_[static_cast<int>(level::trace)] = color::white;
-        colors_[static_cast<int>(level::debug)] = color::cyan;
-        colors_[static_cast<int>(level::info)] = color::green;
-        colors_[static_cast<int>(level::warn)] = color::yellow;
-        colors_[static_cast<int>(level::error)] = color::red;
-        colors_[static_cast<int>(level::critical)] = std::string(color::bold) + color::red;
-    }
+    explicit color_stderr_sink(color_mode mode = color_mode::automatic)
+        : color_console_sink<ConsoleMutex>(details::stderr_fd, mode)
+    {}
     
     ~color_stderr_sink() override = default;
-    
-protected:
-    void sink_it_(const details::log_msg& msg) override {
-        fmt::memory_buffer formatted;
-        this->format_message(msg, formatted);
-        
-        const std::string& prefix = colors_[static_cast<int>(msg.lvl)];
-        
-        std::cerr << prefix;
-        std::cerr.write(formatted.data(), formatted.size());
-        std::cerr << color::reset;
-    }
-    
-    void flush_() override {
-        std::cerr << std::flush;
-    }
-    
-private:
-    std::array<std::string, 7> colors_;
 };
 
 using color_stderr_sink_mt = color_stderr_sink<std::mutex>;
-using color_stderr_sink_st = color_stderr_sink<std::mutex>;
+using color_stderr_sink_st = color_stderr_sink<null_mutex>;
 
 } // namespace sinks
-} // namespace minispdlog
\ No newline at end of file
+} // namespace minispdlog
@@ -1,31 +1,36 @@
 #pragma once
 
 #include "base_sink.h"
-#include <iostream>
+#include "../details/console_output.h"
 #include <mutex>
 
 namespace minispdlog {
 namespace sinks {
 
 // 控制台 Sink
+// 每条记录格式化后只做一次 write(fd 1),不经过 std::cout
 template<typename ConsoleMutex>
-class console_sink : public base_sink<ConsoleMutex> {
+class console_sink : public formatted_sink<ConsoleMutex> {
 public:
     console_sink() = default;
     ~console_sink() override = default;
     
 protected:
-    void sink_it_(const details::log_msg& msg) override {
-        fmt::memory_buffer formatted;
-        this->format_message(msg, formatted);
-        
-        // 输出到 stdout
-        std::cout.write(formatted.data(), formatted.size());
+    // 供 stderr_sink 指定输出的文件描述符
+    explicit console_sink(int fd)
+        : fd_(fd)
+    {}
+    
+    void sink_formatted_(const details::log_msg&, std::string_view formatted) override {
+        details::console_write(fd_, formatted.data(), formatted.size());
     }
     
     void flush_() override {
-        std::cout << std::flush;
+        // 直接写 fd,没有用户态缓冲区
     }
+    
+private:
+    int fd_{details::stdout_fd};
 };
 
 // 多线程安全版本(使用 std::mutex)
@@ -36,26 +41,16 @@ using console_sink_st = console_sink<null_mutex>;
 
 // stderr 版本
 template<typename ConsoleMutex>
-class stderr_sink : public base_sink<ConsoleMutex> {
+class stderr_sink : public console_sink<ConsoleMutex> {
 public:
-    stderr_sink() = default;
+    stderr_sink()
+        : console_sink<ConsoleMutex>(details::stderr_fd)
+    {}
     ~stderr_sink() override = default;
-    
-protected:
-    void sink_it_(const details::log_msg& msg) override {
-        fmt::memory_buffer formatted;
-        this->format_message(msg, formatted);
-        
-        std::cerr.write(formatted.data(), formatted.size());
-    }
-    
-    void flush_() override {
-        std::cerr << std::flush;
-    }
 };
 
 using stderr_sink_mt = stderr_sink<std::mutex>;
 using stderr_sink_st = stderr_sink<null_mutex>;
 
 } // namespace sinks
-} // namespace minispdlog
\ No newline at end of file
+} // namespace minispdlog
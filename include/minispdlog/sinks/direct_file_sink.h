@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../common.h"
+#include "base_sink.h"
+#include "../details/direct_file_writer.h"
+#include <string>
+#include <mutex>
+
+#ifndef MINISPDLOG_WINDOWS
+
+namespace minispdlog {
+namespace sinks {
+
+// direct_file_sink: 绕过页缓存(O_DIRECT)的文件 Sink(仅 POSIX)
+// 可直接替换 file_sink_mt:日志量大时不会把其他进程的热页挤出页缓存
+//
+// 注意:
+//   - 数据按 4KB 整块写出,flush() 前不足一块的尾部只在内存中
+//   - flush() 会写出补齐的尾块并截断回逻辑长度,文件内容中不含填充
+//   - 对齐与回退细节见 details::direct_file_writer
+template<typename Mutex>
+class direct_file_sink : public formatted_sink<Mutex> {
+public:
+    // 构造函数
+    // filename: 文件路径
+    // truncate: true=覆盖文件, false=追加到文件末尾
+    // buffer_size: 对齐缓冲区大小(向上取整到 4KB)
+    explicit direct_file_sink(
+        const std::string& filename,
+        bool truncate = false,
+        size_t buffer_size = 1024 * 1024
+    )
+        : writer_(filename, truncate, buffer_size)
+    {}
+
+    ~direct_file_sink() override = default;
+
+    // 获取文件名
+    const std::string& filename() const {
+        return writer_.filename();
+    }
+
+    // 逻辑长度(包括尚未写出的尾部)
+    size_t size() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return writer_.size();
+    }
+
+    // 是否真正绕过了页缓存
+    bool direct() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return writer_.direct();
+    }
+
+protected:
+    void sink_formatted_(const details::log_msg&, std::string_view formatted) override {
+        writer_.write(formatted.data(), formatted.size());
+    }
+
+    void flush_() override {
+        writer_.flush();
+    }
+
+    void sync_() override {
+        writer_.sync();
+    }
+
+private:
+    details::direct_file_writer writer_;
+};
+
+using direct_file_sink_mt = direct_file_sink<std::mutex>;
+using direct_file_sink_st = direct_file_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace minispdlog
+
+#endif // MINISPDLOG_WINDOWS
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "base_sink.h"
+#include "../rate_limit.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace minispdlog {
+namespace sinks {
+
+// dup_filter_sink: 重复消息过滤 Sink
+// 参考 spdlog 的 dup_filter_sink:包装若干子 sink,连续重复的记录只转发第一条
+//
+// 判定:
+//   - 与上一条转发的记录比较 (payload 与 logger 名的 64 位哈希, 级别),只比哈希不比字符串
+//   - 且距上一条转发的记录不超过 max_skip_duration;超过窗口的重复记录照常转发,
+//     因此持续抖动的依赖每个窗口至少留下一条
+//
+// 被丢弃的重复记录计数,这一串结束时(下一条不同的记录到来、窗口到期后的重复记录到来,或 flush())
+// 先向子 sink 输出一条同级别的 "skipped N duplicates" 记录
+//
+// 注意:
+//   - 子 sink 在本 sink 的锁内调用,各自的级别与 formatter 仍然生效
+//   - set_formatter() 会把 formatter 的副本设置给当前所有子 sink
+//   - 哈希相同而内容不同的记录会被误判为重复(哈希固定为 64 位,与平台的 size_t 宽度无关,概率可以忽略)
+template<typename Mutex>
+class dup_filter_sink : public base_sink<Mutex> {
+public:
+    explicit dup_filter_sink(std::chrono::milliseconds max_skip_duration)
+        : max_skip_duration_(max_skip_duration)
+    {}
+
+    dup_filter_sink(std::chrono::milliseconds max_skip_duration, std::vector<sink_ptr> sinks)
+        : max_skip_duration_(max_skip_duration)
+        , sinks_(std::move(sinks))
+    {}
+
+    ~dup_filter_sink() override = default;
+
+    void add_sink(sink_ptr sink) {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        sinks_.push_back(std::move(sink));
+    }
+
+    void remove_sink(sink_ptr sink) {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        sinks_.erase(std::remove(sinks_.begin(), sinks_.end(), sink), sinks_.end());
+    }
+
+    void set_sinks(std::vector<sink_ptr> sinks) {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        sinks_ = std::move(sinks);
+    }
+
+    std::vector<sink_ptr> sinks() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return sinks_;
+    }
+
+    void set_formatter(std::unique_ptr<formatter> sink_formatter) override {
+        {
+            std::lock_guard<Mutex> lock(this->mutex_);
+            for (auto& s : sinks_) {
+                s->set_formatter(sink_formatter->clone());
+            }
+        }
+        base_sink<Mutex>::set_formatter(std::move(sink_formatter));
+    }
+
+    // 累计丢弃的重复记录数
+    size_t skipped_count() const {
+        return skipped_total_.load(std::memory_order_relaxed);
+    }
+
+protected:
+    void sink_it_(const details::log_msg& msg) override {
+        uint64_t hash = hash_of_(msg);
+        bool duplicate = has_last_ && hash == last_hash_ && msg.lvl == last_level_ &&
+                         msg.time - last_time_ < max_skip_duration_;
+        if (duplicate) {
+            if (skip_count_ == 0) {
+                // 一串重复开始:复制一次 logger 名,之后只计数
+                skipped_logger_.assign(msg.logger_name.data(), msg.logger_name.size());
+            }
+            ++skip_count_;
+            skipped_time_ = msg.time;
+            skipped_total_.store(skipped_total_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+
+        emit_skipped_();
+        forward_(msg);
+        has_last_ = true;
+        last_hash_ = hash;
+        last_level_ = msg.lvl;
+        last_time_ = msg.time;
+    }
+
+    void flush_() override {
+        emit_skipped_();
+        for (auto& s : sinks_) {
+            s->flush();
+        }
+    }
+
+    void sync_() override {
+        emit_skipped_();
+        for (auto& s : sinks_) {
+            s->sync();
+        }
+    }
+
+private:
+    // 复用 rate_limit.h 的稳定哈希(FNV-1a + splitmix64),全程 uint64_t 运算,32 位平台上同样是 64 位;
+    // logger 名的哈希先乘以奇数常量再合并,交换 payload 与 logger 名不会得到相同结果
+    static uint64_t hash_of_(const details::log_msg& msg) {
+        uint64_t name = details::sample_hash(msg.logger_name) * 0x9e3779b97f4a7c15ULL;
+        return details::sample_hash(details::sample_hash(msg.payload) + name);
+    }
+
+    void forward_(const details::log_msg& msg) {
+        for (auto& s : sinks_) {
+            if (s->should_log(msg.lvl)) {
+                s->log(msg);
+            }
+        }
+    }
+
+    // 输出并清零当前这一串的丢弃数
+    void emit_skipped_() {
+        if (skip_count_ == 0) {
+            return;
+        }
+        std::string text = "skipped " + std::to_string(skip_count_) + " duplicates";
+        details::log_msg skipped(skipped_time_, details::source_loc(), skipped_logger_, last_level_, text);
+        skip_count_ = 0;
+        forward_(skipped);
+    }
+
+    const std::chrono::milliseconds max_skip_duration_;
+    std::vector<sink_ptr> sinks_;
+
+    // 以下状态只在持有锁时访问
+    bool has_last_{false};
+    uint64_t last_hash_{0};
+    level last_level_{level::off};
+    log_clock::time_point last_time_;           // 上一条转发的记录的时间
+    size_t skip_count_{0};                      // 当前这一串已丢弃的条数
+    std::string skipped_logger_;
+    log_clock::time_point skipped_time_;
+
+    std::atomic<size_t> skipped_total_{0};
+};
+
+using dup_filter_sink_mt = dup_filter_sink<std::mutex>;
+using dup_filter_sink_st = dup_filter_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace minispdlog
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../common.h"
+#include "base_sink.h"
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#ifndef MINISPDLOG_WINDOWS
+
+namespace minispdlog {
+
+namespace details {
+class periodic_worker;
+}
+
+namespace sinks {
+
+// 用户态缓冲区何时写出(write 系统调用),与 fsync 无关
+enum class fd_flush_mode {
+    never,       // 只在缓冲区满、flush() 和关闭时写出
+    on_level,    // 记录级别 >= flush_level 时写出
+    every_bytes, // 缓冲区中累计 bytes 字节时写出
+    every_ms     // 距上次写出超过 interval 时写出:记录到达时按 log_msg::time 判断(不额外读时钟),
+                 // 线程安全版本(_mt / _fc)另有后台定时器,没有新记录时也按时写出;
+                 // _st 版本没有定时器,只在下一条记录到达时检查
+};
+
+// 写出策略
+struct fd_flush_policy {
+    fd_flush_mode mode{fd_flush_mode::never};
+    level flush_level{level::error};
+    size_t bytes{0};
+    std::chrono::milliseconds interval{0};
+
+    static fd_flush_policy never() {
+        return fd_flush_policy();
+    }
+
+    static fd_flush_policy on_level(level lvl) {
+        fd_flush_policy p;
+        p.mode = fd_flush_mode::on_level;
+        p.flush_level = lvl;
+        return p;
+    }
+
+    static fd_flush_policy every_bytes(size_t n) {
+        fd_flush_policy p;
+        p.mode = fd_flush_mode::every_bytes;
+        p.bytes = n;
+        return p;
+    }
+
+    static fd_flush_policy every(std::chrono::milliseconds t) {
+        fd_flush_policy p;
+        p.mode = fd_flush_mode::every_ms;
+        p.interval = t;
+        return p;
+    }
+};
+
+// fd_file_sink: 直接基于文件描述符的文件 Sink(仅 POSIX)
+// 与 file_sink 的区别:
+//   - 不经过 std::ofstream(没有 locale、sentry 和虚 streambuf 开销)
+//   - 用户态缓冲区大小可配置(默认 1MB),何时发起系统调用由 fd_flush_policy 决定
+//   - 记录放不进剩余空间时,用一次 writev 同时写出缓冲区和这条记录,不做额外拷贝
+template<typename Mutex>
+class fd_file_sink : public formatted_sink<Mutex> {
+public:
+    // 构造函数
+    // filename: 文件路径
+    // truncate: true=覆盖文件, false=追加到文件末尾
+    // buffer_size: 用户态缓冲区大小
+    // policy: 写出策略
+    explicit fd_file_sink(
+        const std::string& filename,
+        bool truncate = false,
+        size_t buffer_size = 1024 * 1024,
+        fd_flush_policy policy = fd_flush_policy::never()
+    );
+
+    ~fd_file_sink() override;
+
+    // 获取文件名
+    const std::string& filename() const;
+
+    // 已发起的 write/writev 次数
+    size_t syscalls() const;
+
+protected:
+    void sink_formatted_(const details::log_msg& msg, std::string_view formatted) override;
+    void flush_() override;
+    void sync_() override;
+
+private:
+    // 写出缓冲区,可选地在同一次 writev 中追加 extra
+    void write_out_(const char* extra, size_t extra_len);
+
+    // every_ms 定时器回调:持锁,缓冲区有数据且距上次写出已超过 interval 时写出
+    void write_out_if_due_();
+
+    std::string filename_;                     // 文件名
+    int fd_;                                   // 文件描述符
+    std::vector<char> buffer_;                 // 用户态缓冲区
+    size_t used_;                              // 缓冲区中的字节数
+    fd_flush_policy policy_;                   // 写出策略
+    log_clock::time_point last_write_out_;     // 上次写出时刻(every_ms 使用)
+    size_t syscalls_;                          // 系统调用计数
+    std::unique_ptr<details::periodic_worker> timer_;  // every_ms 的后台定时器(最后初始化)
+};
+
+using fd_file_sink_mt = fd_file_sink<std::mutex>;
+using fd_file_sink_st = fd_file_sink<null_mutex>;
+using fd_file_sink_fc = fd_file_sink<details::combining_mutex>;
+
+} // namespace sinks
+} // namespace minispdlog
+
+#endif // MINISPDLOG_WINDOWS
@@ -4,6 +4,13 @@
 #include <fstream>
 #include <string>
 #include <mutex>
+#include <system_error>
+
+#ifndef MINISPDLOG_WINDOWS
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace minispdlog {
 namespace sinks {
@@ -11,31 +18,46 @@ namespace sinks {
 // file_sink:基础文件输出 Sink
 // 参考 spdlog 的 basic_file_sink
 template<typename Mutex>
-class file_sink : public base_sink<Mutex> {
+class file_sink : public formatted_sink<Mutex> {
 public:
     // 构造函数
     // filename: 文件路径
     // truncate: true=覆盖文件, false=追加到文件末尾
-    explicit file_sink(const std::string& filename, bool truncate = false) {
+    explicit file_sink(const std::string& filename, bool truncate = false)
+        : filename_(filename)
+    {
         auto mode = truncate ? std::ios::trunc : std::ios::app;
         file_.open(filename, std::ios::out | mode);
         
         if (!file_.is_open()) {
             throw std::runtime_error("Failed to open file: " + filename);
         }
+#ifndef MINISPDLOG_WINDOWS
+        // ofstream 不暴露文件描述符;紧接着按同一路径打开只读描述符供 sync_() 使用,
+        // 保证两者指向同一个 inode(之后路径被改名或替换也不影响)
+        sync_fd_ = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (sync_fd_ < 0) {
+            int err = errno;
+            file_.close();
+            throw std::system_error(err, std::generic_category(),
+                                    "file_sink: Failed to open file for sync: " + filename);
+        }
+#endif
     }
     
     ~file_sink() override {
         if (file_.is_open()) {
             file_.close();
         }
+#ifndef MINISPDLOG_WINDOWS
+        if (sync_fd_ >= 0) {
+            ::close(sync_fd_);
+        }
+#endif
     }
     
 protected:
-    void sink_it_(const details::log_msg& msg) override {
-        fmt::memory_buffer formatted;
-        this->format_message(msg, formatted);
-        
+    void sink_formatted_(const details::log_msg&, std::string_view formatted) override {
         // 写入文件
         file_.write(formatted.data(), formatted.size());
     }
@@ -44,12 +66,29 @@ protected:
         file_.flush();
     }
     
+    // 任何一步失败都抛出异常,持久化凭据不会在数据未落盘时报告完成
+    void sync_() override {
+        file_.flush();
+        if (!file_) {
+            throw std::runtime_error("file_sink: flush failed: " + filename_);
+        }
+#ifndef MINISPDLOG_WINDOWS
+        // fdatasync 作用于 inode,通过构造时打开的只读描述符即可
+        if (::fdatasync(sync_fd_) != 0) {
+            throw std::system_error(errno, std::generic_category(), "file_sink: fdatasync failed: " + filename_);
+        }
+#endif
+    }
+    
 private:
+    std::string filename_;
     std::ofstream file_;
+    int sync_fd_{-1};           // 仅用于 sync_() 的只读描述符(与 file_ 同时打开)
 };
 
 using file_sink_mt = file_sink<std::mutex>;
 using file_sink_st = file_sink<null_mutex>;
+using file_sink_fc = file_sink<details::combining_mutex>;  // 高并发写入(flat combining)
 
 } // namespace sinks
 } // namespace minispdlog
\ No newline at end of file
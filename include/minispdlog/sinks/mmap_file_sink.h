@@ -0,0 +1,93 @@
+#pragma once
+
+#include "../common.h"
+#include "base_sink.h"
+#include <string>
+#include <mutex>
+
+#ifndef MINISPDLOG_WINDOWS
+
+namespace minispdlog {
+namespace sinks {
+
+// msync 策略
+enum class msync_policy {
+    never,      // 只依赖页缓存:进程崩溃不丢数据,掉电可能丢
+    async,      // flush() 时 msync(MS_ASYNC),尽早启动回写
+    sync        // flush() 时 msync(MS_SYNC),返回时数据已落盘
+};
+
+// mmap_file_sink: 内存映射追加写的文件 Sink(仅 POSIX)
+//
+// 写入方式:
+//   - 按 chunk_size 把文件映射成一个窗口,格式化后的记录直接 memcpy 进映射
+//   - 窗口写满时用 ftruncate + fallocate 扩展文件,再映射下一个窗口
+//   - 没有 fwrite 调用,也没有 stdio 缓冲区的二次拷贝
+//   - 数据进入页缓存即可在进程崩溃后保留
+//
+// 文件长度:
+//   - 映射期间文件长度是按块扩展的,末尾是未写入的 0
+//   - 窗口最后 16 字节保留给长度记录(魔数 + 逻辑长度),每条记录写入后更新
+//   - 关闭时截断到逻辑长度,长度记录随之去掉
+//   - 启动时(崩溃恢复)只有文件末尾是本 sink 的长度记录才截断到其中的长度;
+//     其他文件原样保留并在末尾追加,不根据末尾的 0 推断长度
+template<typename Mutex>
+class mmap_file_sink : public formatted_sink<Mutex> {
+public:
+    // 构造函数
+    // filename: 文件路径
+    // truncate: true=覆盖文件, false=追加到文件末尾
+    // chunk_size: 每次映射/扩展的字节数(向上取整到页大小)
+    // policy: flush() 时的 msync 策略
+    explicit mmap_file_sink(
+        const std::string& filename,
+        bool truncate = false,
+        size_t chunk_size = 16 * 1024 * 1024,
+        msync_policy policy = msync_policy::never
+    );
+
+    ~mmap_file_sink() override;
+
+    // 获取文件名
+    const std::string& filename() const;
+
+    // 已写入的逻辑长度
+    size_t size() const;
+
+protected:
+    void sink_formatted_(const details::log_msg& msg, std::string_view formatted) override;
+    void flush_() override;
+    void sync_() override;
+
+private:
+    // 从 logical_size_ 所在页开始映射一个至少能容纳 min_len 字节的新窗口
+    void remap_(size_t min_len);
+
+    // 解除当前窗口的映射
+    void unmap_();
+
+    // 崩溃恢复:文件末尾是长度记录时返回其中的逻辑长度,否则返回 file_size
+    size_t recover_logical_size_(size_t file_size);
+
+    // 在当前窗口末尾写入完整的长度记录(魔数 + 逻辑长度)
+    void write_trailer_();
+
+    std::string filename_;         // 文件名
+    int fd_;                       // 文件描述符
+    size_t chunk_size_;            // 映射窗口大小(页对齐)
+    size_t page_size_;             // 系统页大小
+    msync_policy policy_;          // msync 策略
+    char* map_base_;               // 当前窗口起始地址
+    size_t map_offset_;            // 当前窗口在文件中的偏移(页对齐)
+    size_t map_len_;               // 当前窗口长度
+    size_t logical_size_;          // 已写入的逻辑长度
+    bool remapped_since_flush_;    // 上次 flush 之后是否换过窗口
+};
+
+using mmap_file_sink_mt = mmap_file_sink<std::mutex>;
+using mmap_file_sink_st = mmap_file_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace minispdlog
+
+#endif // MINISPDLOG_WINDOWS
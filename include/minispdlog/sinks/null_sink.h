@@ -0,0 +1,27 @@
+#pragma once
+
+#include "base_sink.h"
+#include <mutex>
+
+namespace minispdlog {
+namespace sinks {
+
+// null_sink: 格式化后丢弃的 Sink
+// 参考 spdlog 的 null_sink,区别是仍然执行格式化:
+//   用于基准测试时,它衡量的是除 I/O 以外的全部开销(过滤、格式化、加锁、计数)
+template<typename Mutex>
+class null_sink : public formatted_sink<Mutex> {
+public:
+    null_sink() = default;
+
+protected:
+    void sink_formatted_(const details::log_msg&, std::string_view) override {}
+
+    void flush_() override {}
+};
+
+using null_sink_mt = null_sink<std::mutex>;
+using null_sink_st = null_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace minispdlog
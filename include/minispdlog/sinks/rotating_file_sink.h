@@ -3,12 +3,28 @@
 #include "../common.h"
 #include "base_sink.h"
 #include "file_sink.h"
+#include "../details/background_worker.h"
+#include <atomic>
 #include <string>
 #include <cstdio>
+#include <deque>
+#include <future>
+#include <memory>
+#include <utility>
 
 namespace minispdlog {
+namespace details {
+class direct_file_writer;
+}
+
 namespace sinks {
 
+// 轮转命名方案
+enum class rotation_scheme {
+    rename_cascade,   // 重命名级联:mylog.txt → mylog.1.txt → mylog.2.txt ...(默认)
+    monotonic_index   // 单调递增序号:mylog.000001.txt, mylog.000002.txt ...(轮转 O(1))
+};
+
 // rotating_file_sink: 按大小滚动的文件 Sink
 // 参考 spdlog 设计:当文件大小超过限制时自动轮转
 //
@@ -18,20 +34,43 @@ namespace sinks {
 //   - mylog.1.txt → mylog.2.txt (如果存在)
 //   - 创建新的 mylog.txt
 //   - 当达到 max_files 限制时,删除最旧的文件
+//
+// monotonic_index 方案:
+//   - 当前文件始终是序号最大的段,如 mylog.000123.txt
+//   - 轮转时直接打开 mylog.000124.txt,只删除最旧的一个段
+//   - 内存中维护现存段序号,启动时扫描目录重建
+//   - 轮转代价与 max_files 无关(无 stat/rename 级联)
+//
+// preopen_next(仅 monotonic_index):
+//   - 当前段写到 3/4 时,后台线程预先创建并 fallocate 下一个段
+//   - 轮转时只交换文件句柄,旧句柄交给后台线程 fflush + fsync + fclose
+//   - 删除最旧段也在后台完成,生产者在锁内看到的只是一次指针交换
+//   - sync() 会等待已排队的旧段 fsync 完成,旧段落盘失败在下一次 sync() 时抛出
+//
+// direct_io(仅 POSIX):
+//   - 每个段都用 details::direct_file_writer 以 O_DIRECT 写入,不经过页缓存
+//   - 轮转时关闭旧段会写出补齐的尾块并截断回逻辑长度
+//   - 不能与 preopen_next 同时使用(预创建的是 stdio 句柄)
 template<typename Mutex>
-class rotating_file_sink : public base_sink<Mutex> {
+class rotating_file_sink : public formatted_sink<Mutex> {
 public:
     // 构造函数
     // base_filename: 基础文件名,如 "logs/mylog.txt"
     // max_size: 单个文件最大字节数
     // max_files: 最多保留的文件数量(不包括当前文件)
+    // scheme: 轮转命名方案
+    // preopen_next: 后台预创建下一个段并异步关闭旧段(要求 monotonic_index)
+    // direct_io: 以 O_DIRECT 写入各个段(不能与 preopen_next 同时使用)
     rotating_file_sink(
         const std::string& base_filename,
         size_t max_size,
-        size_t max_files
+        size_t max_files,
+        rotation_scheme scheme = rotation_scheme::rename_cascade,
+        bool preopen_next = false,
+        bool direct_io = false
     );
     
-    ~rotating_file_sink() override = default;
+    ~rotating_file_sink() override;
     
     // 获取当前文件名
     std::string filename() const;
@@ -42,14 +81,48 @@ public:
     // calc_filename("logs/mylog.txt", 3) => "logs/mylog.3.txt"
     static std::string calc_filename(const std::string& base_filename, size_t index);
     
+    // 根据序号计算 monotonic_index 方案的文件名
+    // calc_indexed_filename("logs/mylog.txt", 123) => "logs/mylog.000123.txt"
+    static std::string calc_indexed_filename(const std::string& base_filename, size_t index);
+    
+    // 拆分文件名与扩展名,calc_filename / calc_indexed_filename 与重启时的目录扫描共用
+    // split_by_extension("logs/mylog.txt") => {"logs/mylog", ".txt"}
+    // 以点开头的文件名(".app"、"logs/.app")、结尾是点或点在目录部分时没有扩展名
+    static std::pair<std::string, std::string> split_by_extension(const std::string& filename);
+    
 protected:
-    void sink_it_(const details::log_msg& msg) override;
+    void sink_formatted_(const details::log_msg& msg, std::string_view formatted) override;
     void flush_() override;
+    void sync_() override;
+    
+    // 以下轮转机制供派生类(如 time_rotating_file_sink)复用,调用时须已持有 mutex_
     
-private:
     // 执行文件轮转
     void rotate_();
     
+    // 切换到新的基础文件名并打开(追加模式),不做任何重命名
+    void reopen_(const std::string& base_filename);
+    
+private:
+    // 打开 base_filename_ 对应的当前文件,并读取其已有大小
+    void open_current_();
+    
+    // 打开/关闭当前段(按 direct_io_ 选择 stdio 或 direct_file_writer)
+    bool open_file_(const std::string& filename, bool truncate);
+    void close_file_();
+    
+    // monotonic_index 方案的轮转:打开下一个序号的文件,删除最旧的段
+    void rotate_indexed_();
+    
+    // 扫描目录,重建现存段序号(仅 monotonic_index 使用)
+    void scan_segments_();
+    
+    // 让后台线程预创建下一个段(仅 preopen_next 使用)
+    void prepare_next_();
+    
+    // 丢弃尚未使用的预创建段(关闭并删除空文件)
+    void discard_prepared_();
+    
     // 文件重命名(返回是否成功)
     bool rename_file_(const std::string& src, const std::string& target);
     
@@ -67,6 +140,14 @@ private:
     size_t max_files_;             // 最多保留文件数
     size_t current_size_;          // 当前文件大小
     FILE* file_;                    // 文件句柄
+    rotation_scheme scheme_;       // 轮转命名方案
+    std::deque<size_t> segments_;  // 现存段序号(升序,末尾为当前文件)
+    bool preopen_next_;            // 是否预创建下一个段
+    std::future<FILE*> next_file_; // 后台预创建的下一个段(valid() 表示已发起)
+    std::atomic<int> retire_errno_{0};  // 后台关闭旧段失败时的 errno(须在 worker_ 之前声明)
+    std::unique_ptr<details::background_worker> worker_;  // 后台 I/O 线程(仅 preopen_next)
+    bool direct_io_;               // 是否以 O_DIRECT 写入
+    std::unique_ptr<details::direct_file_writer> direct_;  // direct_io 时的当前段
 };
 
 // 类型别名
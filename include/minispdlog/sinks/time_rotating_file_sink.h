@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../common.h"
+#include "rotating_file_sink.h"
+#include <string>
+#include <limits>
+
+namespace minispdlog {
+namespace sinks {
+
+// 按时间轮转的周期
+enum class rotation_period {
+    hourly,   // 每小时整点
+    daily     // 每天 rotation_hour:rotation_minute(默认午夜)
+};
+
+// time_rotating_file_sink: 按时间(可叠加大小)滚动的文件 Sink
+// 复用 rotating_file_sink 的轮转机制:
+//   - 文件名模式支持日期占位符(strftime 语法),如 "logs/app_%Y-%m-%d.log"
+//   - 到达时间边界时,按新周期展开文件名并切换过去
+//   - 模式不含日期占位符时,时间边界等同于一次普通轮转
+//   - max_size > 0 时,周期内仍按大小轮转(app_2025-01-01.1.log ...)
+//
+// 性能:
+//   - 下一个轮转时刻只在轮转时计算一次
+//   - 每条日志只做一次 log_msg::time 与 next_rollover_ 的整数比较,无 localtime 调用
+template<typename Mutex>
+class time_rotating_file_sink : public rotating_file_sink<Mutex> {
+public:
+    // 构造函数
+    // filename_pattern: 文件名模式,如 "logs/app_%Y-%m-%d.log"
+    // period: 轮转周期
+    // max_size: 单个文件最大字节数(0 表示只按时间轮转)
+    // max_files: 每个周期内最多保留的文件数量(不包括当前文件)
+    // rotation_hour/rotation_minute: daily 模式下的轮转时刻
+    time_rotating_file_sink(
+        std::string filename_pattern,
+        rotation_period period,
+        size_t max_size = 0,
+        size_t max_files = 1,
+        rotation_scheme scheme = rotation_scheme::rename_cascade,
+        int rotation_hour = 0,
+        int rotation_minute = 0
+    );
+
+    ~time_rotating_file_sink() override = default;
+
+    // 按时间点展开文件名模式
+    // calc_filename("logs/app_%Y-%m-%d.log", tp) => "logs/app_2025-01-01.log"
+    static std::string calc_filename(const std::string& filename_pattern, log_clock::time_point tp);
+
+    // 下一次按时间轮转的时刻
+    log_clock::time_point next_rollover() const;
+
+protected:
+    void sink_formatted_(const details::log_msg& msg, std::string_view formatted) override;
+
+private:
+    // 计算 tp 之后的第一个轮转时刻(只在轮转时调用,允许使用 localtime)
+    log_clock::time_point calc_next_rollover_(log_clock::time_point tp) const;
+
+    std::string filename_pattern_;           // 文件名模式
+    rotation_period period_;                 // 轮转周期
+    int rotation_hour_;                      // daily 轮转小时
+    int rotation_minute_;                    // daily 轮转分钟
+    std::string current_base_;               // 当前周期展开后的基础文件名
+    log_clock::time_point next_rollover_;    // 预先计算好的下一个轮转时刻
+};
+
+// 类型别名
+using time_rotating_file_sink_mt = time_rotating_file_sink<std::mutex>;
+using time_rotating_file_sink_st = time_rotating_file_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace minispdlog
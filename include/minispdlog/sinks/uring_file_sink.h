@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../common.h"
+#include "base_sink.h"
+#include "../details/uring_file_writer.h"
+#include <string>
+#include <mutex>
+
+#ifdef MINISPDLOG_LINUX
+
+namespace minispdlog {
+namespace sinks {
+
+// uring_file_sink: 通过 io_uring 异步提交写入的文件 Sink(仅 Linux)
+// 适合放在异步 logger 后面:后台线程只负责格式化和 memcpy,
+// 磁盘变慢时写入在内核中排队,而不是阻塞在 fwrite/fflush 上
+//
+// 缓冲与回退细节见 details::uring_file_writer
+template<typename Mutex>
+class uring_file_sink : public formatted_sink<Mutex> {
+public:
+    // 构造函数
+    // filename: 文件路径
+    // truncate: true=覆盖文件, false=追加到文件末尾
+    // buffer_size: 单个缓冲区大小
+    // buffer_count: 缓冲区数量(2=双缓冲, 3=三缓冲)
+    // fsync_on_flush: flush() 时是否额外提交 fdatasync
+    explicit uring_file_sink(
+        const std::string& filename,
+        bool truncate = false,
+        size_t buffer_size = 256 * 1024,
+        size_t buffer_count = 3,
+        bool fsync_on_flush = false
+    )
+        : writer_(filename, truncate, buffer_size, buffer_count, fsync_on_flush)
+    {}
+    
+    ~uring_file_sink() override = default;
+    
+    // 是否真正使用了 io_uring(false 表示已回退到 pwrite)
+    bool using_io_uring() const {
+        return writer_.using_io_uring();
+    }
+    
+    // 因缓冲区仍在写入而等待的次数
+    size_t buffer_waits() const {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        return writer_.buffer_waits();
+    }
+    
+protected:
+    void sink_formatted_(const details::log_msg&, std::string_view formatted) override {
+        writer_.write(formatted.data(), formatted.size());
+    }
+    
+    void flush_() override {
+        writer_.flush();
+    }
+    
+    void sync_() override {
+        writer_.sync();
+    }
+    
+private:
+    details::uring_file_writer writer_;
+};
+
+using uring_file_sink_mt = uring_file_sink<std::mutex>;
+using uring_file_sink_st = uring_file_sink<null_mutex>;
+
+} // namespace sinks
+} // namespace minispdlog
+
+#endif // MINISPDLOG_LINUX